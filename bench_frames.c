@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "frames.h"
+
+// Microbenchmark das varreduras da tabela de quadros: menor instante de acesso e primeiro
+// quadro inválido, de 64 a 32768 quadros. Compara a varredura escalar sobre o vetor de structs
+// antigo (um Frame por quadro) com os kernels da estrutura de vetores que o processador suporta.
+// Uso: bench_frames [quadros_min [quadros_max]]
+
+#define MIN_FRAMES 64
+#define MAX_FRAMES 32768
+// Quadros varridos por medida, para as tabelas pequenas repetirem mais vezes
+#define FRAMES_PER_MEASURE (1u << 26)
+
+// Layout antigo de doisNiveis/tresNiveis
+typedef struct {
+    void *entry;
+    int page_number;
+    int valid;
+    int modified;
+    int referenced;
+    unsigned last_access;
+} AosFrame;
+
+static volatile int sink;
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+__attribute__((noinline))
+static int aos_min_access(const AosFrame *frames, unsigned count) {
+    unsigned best = 0;
+    for (unsigned i = 1; i < count; i++) {
+        if (frames[i].last_access < frames[best].last_access) {
+            best = i;
+        }
+    }
+    return (int)best;
+}
+
+__attribute__((noinline))
+static int aos_first_invalid(const AosFrame *frames, unsigned count) {
+    for (unsigned i = 0; i < count; i++) {
+        if (!frames[i].valid) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// Nanossegundos por varredura
+static double time_aos(int (*scan)(const AosFrame *, unsigned), const AosFrame *frames, unsigned count) {
+    unsigned repeats = FRAMES_PER_MEASURE / count;
+    double start = now_seconds();
+    for (unsigned r = 0; r < repeats; r++) {
+        sink = scan(frames, count);
+    }
+    return (now_seconds() - start) * 1e9 / repeats;
+}
+
+// Os simuladores não guardam instantes de acesso (o LRU usa a lista de recência), então o vetor
+// de instantes é só do microbenchmark, alocado como os campos da tabela de quadros
+static double time_min(const FrameKernels *kernels, const uint32_t *stamps, unsigned count) {
+    unsigned repeats = FRAMES_PER_MEASURE / count;
+    double start = now_seconds();
+    for (unsigned r = 0; r < repeats; r++) {
+        sink = kernels->min_index(stamps, count);
+    }
+    return (now_seconds() - start) * 1e9 / repeats;
+}
+
+static double time_invalid(const FrameKernels *kernels, const FrameTable *table) {
+    unsigned repeats = FRAMES_PER_MEASURE / table->count;
+    double start = now_seconds();
+    for (unsigned r = 0; r < repeats; r++) {
+        sink = kernels->find_byte(table->valid, 0, table->count, 0);
+    }
+    return (now_seconds() - start) * 1e9 / repeats;
+}
+
+int main(int argc, char *argv[]) {
+
+    unsigned min_frames = argc > 1 ? (unsigned)atoi(argv[1]) : MIN_FRAMES;
+    unsigned max_frames = argc > 2 ? (unsigned)atoi(argv[2]) : MAX_FRAMES;
+    if (min_frames == 0 || max_frames < min_frames) {
+        fprintf(stderr, "Uso: %s [quadros_min [quadros_max]]\n", argv[0]);
+        return 1;
+    }
+
+    const FrameKernels *kernels[3];
+    int num_kernels = frames_supported_kernels(kernels, 3);
+
+    printf("%-8s %-12s %12s", "quadros", "varredura", "aos_ns");
+    for (int k = 0; k < num_kernels; k++) {
+        printf(" %10s_ns", kernels[k]->name);
+    }
+    printf(" %12s\n", "ganho");
+
+    srand(1);
+    for (unsigned count = min_frames; count <= max_frames; count *= 2) {
+
+        // Instantes distintos em ordem aleatória; só o último quadro é inválido, então as duas
+        // varreduras percorrem a tabela inteira
+        AosFrame *aos = (AosFrame *)calloc(count, sizeof(AosFrame));
+        FrameTable table;
+        frames_init(&table, count);
+        uint32_t *stamps = (uint32_t *)frames_alloc_array(count, sizeof(uint32_t));
+        for (unsigned i = 0; i < count; i++) {
+            unsigned stamp = (unsigned)rand() + 1;
+            aos[i].last_access = stamps[i] = stamp;
+            aos[i].valid = table.valid[i] = (i + 1 < count);
+        }
+
+        const char *names[2] = {"menor_acesso", "invalido"};
+        for (int scan = 0; scan < 2; scan++) {
+            double aos_ns = scan == 0 ? time_aos(aos_min_access, aos, count)
+                                      : time_aos(aos_first_invalid, aos, count);
+            double best_ns = aos_ns;
+            printf("%-8u %-12s %12.1f", count, names[scan], aos_ns);
+            for (int k = 0; k < num_kernels; k++) {
+                double ns = scan == 0 ? time_min(kernels[k], stamps, count) : time_invalid(kernels[k], &table);
+                if (ns < best_ns) {
+                    best_ns = ns;
+                }
+                printf(" %13.1f", ns);
+            }
+            printf(" %11.1fx\n", aos_ns / best_ns);
+        }
+
+        frames_free(&table);
+        free(stamps);
+        free(aos);
+    }
+
+    return 0;
+}
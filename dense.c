@@ -3,94 +3,182 @@
 #include <string.h>
 #include <math.h>
 #include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "lru.h"
+#include "opt.h"
+#include "prof.h"
+#include "pte.h"
+#include "repl.h"
+#include "series.h"
+#include "shards.h"
+#include "trace.h"
+#include "writeback.h"
+#include "sim.h"
 
 // Constantes globais
-#define MAX_PAGE_TABLE_SIZE (1 << 21) // Máximo número de páginas (para páginas >= 2 KB e endereços de 32 bits)
+#define ADDRESS_BITS 32
 #define TRUE 1
 #define FALSE 0
 
 // Estruturas de dados
+// A tabela de páginas é um vetor de PageTableEntry (pte.h) com uma entrada por página virtual;
+// os bits de suja e referenciada ficam na entrada e o quadro guarda a página que contém
 typedef struct {
-    int page_number;
-    int frame_number;
-    int valid;
-    int modified;
-    unsigned long last_access_time;
-} PageTableEntry;
-
-typedef struct {
-    int frame_number;
-    int page_number;
-    int valid;
-    int modified;
-    int reference;
+    int page_number;                 // -1 enquanto o quadro estiver livre
 } Frame;
 
 // Variáveis globais
-unsigned page_size, memory_size;
-unsigned num_frames;
-unsigned s;
-Frame *physical_memory;
-PageTableEntry *page_table;
-char replacement_policy[10];
-unsigned long access_count = 0;
-unsigned long page_faults = 0;
-unsigned long dirty_pages_written = 0;
+static _Thread_local unsigned page_size, memory_size;
+static _Thread_local unsigned num_frames;
+static _Thread_local unsigned s;
+static _Thread_local Frame *physical_memory;
+static _Thread_local PageTableEntry *page_table;
+static _Thread_local size_t page_table_bytes;
+static _Thread_local char replacement_policy[10];
+static _Thread_local unsigned long access_count = 0;
+static _Thread_local unsigned long page_faults = 0;
+static _Thread_local unsigned long dirty_pages_written = 0;
+static _Thread_local unsigned next_free_frame = 0;
+static _Thread_local unsigned fifo_next_frame = 0;
+static _Thread_local unsigned clock_pointer = 0;
+static _Thread_local LruList lru_list;
+static _Thread_local SimRandom rng;
+static _Thread_local int policy_id;
+static _Thread_local Tlb tlb;
+static _Thread_local Repl repl;
+static _Thread_local Opt opt;
+static _Thread_local Writeback writeback;
+static _Thread_local Shards shards;
+static _Thread_local Series series;
+static _Thread_local int address_rejected;
 
 // Funções auxiliares
-void parse_arguments(int argc, char *argv[]);
-void initialize_simulator();
-void process_memory_access(unsigned addr, char rw);
-int find_page_in_memory(int page_number);
-void handle_page_fault(int page_number, char rw);
-int select_victim_frame();
-void print_report(const char *input_file);
-int iteracao = 0;
-
+static int configure_simulator(const char *policy, unsigned page_size_kb, unsigned memory_kb);
+static void initialize_simulator();
+static void release_simulator();
+static size_t resident_table_bytes();
+SIM_INLINE void simulate_accesses(TraceReader *trace, const int policy);
+SIM_INLINE TlbEntry *process_memory_access(unsigned addr, char rw, const int policy);
+SIM_INLINE void repeat_page_access(int page_number, TlbEntry *cached, unsigned long repeats, int written, const int policy);
+SIM_INLINE void handle_page_fault(int page_number, char rw, const int policy);
+SIM_INLINE int select_victim_frame(int page_number, const int policy);
+SIM_INLINE void set_entry_bits(PageTableEntry *entry, PageTableEntry bits);
+static void run_writeback() SIM_COLD;
+static SeriesSample window_sample();
+static void record_window() SIM_COLD;
+static void reject_address(uint64_t addr) SIM_COLD;
+static void print_report(const char *input_file) SIM_UNUSED;
+
+SIM_DEFINE_KERNELS(simulate_accesses);
+
+#ifndef SIM_LIBRARY
 // Função principal
 int main(int argc, char *argv[]) {
-    if (argc != 5) {
-        fprintf(stderr, "Uso: tp2virtual <algoritmo> <arquivo.log> <tamanho_pagina_kb> <memoria_kb>\n");
+    if (argc < 5 || argc > 10) {
+        fprintf(stderr, "Uso: tp2virtual <algoritmo> <arquivo.log> <tamanho_pagina_kb> <memoria_kb> [tlb=entradas/vias/politica] [wb=periodo/lote/fundo/limite] [shards=taxa/paginas] [prof=json|csv[:arquivo]] [series=janela[/csv|/bin][:arquivo]]\n");
         exit(EXIT_FAILURE);
     }
 
-    parse_arguments(argc, argv);
-
-    initialize_simulator();
-
-    FILE *input_file = fopen(argv[2], "r");
-    if (!input_file) {
+    TraceReader input_file;
+    if (trace_open(&input_file, argv[2]) != 0) {
         perror("Erro ao abrir o arquivo de entrada");
         exit(EXIT_FAILURE);
     }
 
-    unsigned addr;
-    char rw;
-    while (fscanf(input_file, "%x %c", &addr, &rw) != EOF) {
-        process_memory_access(addr, rw);
+    // O executável dense sempre sorteou a política random com a hora atual
+    SimConfig config = {argv[1], atoi(argv[3]), atoi(argv[4]), (unsigned)time(NULL), 0};
+    for (int i = 5; i < argc; i++) {
+        if (sim_parse_tlb_option(argv[i], &config) != 1 && sim_parse_writeback_option(argv[i], &config) != 1 &&
+            sim_parse_shards_option(argv[i], &config) != 1 && sim_parse_profile_option(argv[i], &config) != 1 &&
+            sim_parse_series_option(argv[i], &config) != 1) {
+            fprintf(stderr, "Opção inválida: %s\n", argv[i]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    SimResult result;
+    if (dense_simulate(&config, &input_file, &result) != 0) {
+        exit(EXIT_FAILURE);
     }
-    fclose(input_file);
 
     print_report(argv[2]);
+    trace_print_stats(&input_file);
+    if (config.profile_format != PROF_FORMAT_NONE &&
+        prof_write(&sim_profile, config.profile_format, config.profile_path, "dense", argv[1], argv[2], result.accesses) != 0) {
+        exit(EXIT_FAILURE);
+    }
+    trace_close(&input_file);
 
     return 0;
 }
+#endif
+
+// Executa a simulação completa do trace (chamada pelo main e pelo sweep)
+int dense_simulate(const SimConfig *config, TraceReader *trace, SimResult *result) {
+
+    if (configure_simulator(config->policy, config->page_size_kb, config->memory_kb) != 0) {
+        return -1;
+    }
+
+    if (shards_init(&shards, config->sample_rate, config->sample_budget, trace, s) != 0) {
+        return -1;
+    }
+    num_frames = shards_frames(&shards, num_frames);
 
-// Lê os argumentos da entrada e verifica-os
-void parse_arguments(int argc, char *argv[]) {
+    sim_random_seed(&rng, config->seed);
+    tlb_init(&tlb, config->tlb_entries, config->tlb_ways, config->tlb_policy);
+    writeback_init(&writeback, config->wb_period, config->wb_batch,
+                   config->wb_background_ratio, config->wb_dirty_ratio, num_frames);
 
-    strcpy(replacement_policy, argv[1]);
+    initialize_simulator();
+    if (policy_id == POLICY_OPT && opt_init(&opt, trace, s, num_frames) != 0) {
+        release_simulator();
+        return -1;
+    }
+
+    if (series_start(&series, config->series_window, config->series_format, config->series_path,
+                     shards.enabled ? shards.rate : 0) != 0) {
+        release_simulator();
+        return -1;
+    }
+
+    PROF_RUN_BEGIN();
+    kernels[policy_id](trace);
+    PROF_RUN_END();
+    SeriesSample last = window_sample();
+    if (series_finish(&series, &last) != 0 || address_rejected || trace->failed) {
+        release_simulator();
+        return -1;
+    }
 
-    if (strcmp(replacement_policy, "random") != 0 &&
-    strcmp(replacement_policy, "fifo") != 0 &&
-    strcmp(replacement_policy, "lru") != 0 &&
-    strcmp(replacement_policy, "2a") != 0) {
-    fprintf(stderr, "Erro: Política de substituição desconhecida: %s\n", replacement_policy);
-    exit(EXIT_FAILURE);
+    result->page_faults = page_faults;
+    result->pages_written = dirty_pages_written;
+    result->accesses = access_count;
+    result->tlb_hits = tlb.hits;
+    result->ghost_hits = sim_policy_uses_repl(policy_id) ? repl.ghost_hits : 0;
+    result->page_table_bytes = resident_table_bytes();
+    sim_writeback_result(&writeback, result);
+    sim_shards_result(&shards, result);
+
+    release_simulator();
+    return 0;
 }
 
-    page_size = atoi(argv[3]) * 1024;
-    memory_size = atoi(argv[4]) * 1024;
+// Lê e verifica a configuração da simulação
+static int configure_simulator(const char *policy, unsigned page_size_kb, unsigned memory_kb) {
+
+    policy_id = sim_policy_id(policy);
+    if (policy_id < 0) {
+        fprintf(stderr, "Erro: Política de substituição desconhecida: %s\n", policy);
+        return -1;
+    }
+
+    strcpy(replacement_policy, policy);
+
+    page_size = page_size_kb * 1024;
+    memory_size = memory_kb * 1024;
     num_frames = memory_size / page_size;
 
     // Calcular o deslocamento s - offset
@@ -100,138 +188,325 @@ void parse_arguments(int argc, char *argv[]) {
         tmp >>= 1;
         s++;
     }
+
+    return 0;
 }
 
 // Inicializar a memória física e tabela de páginas
-void initialize_simulator() {
+static void initialize_simulator() {
 
-    srandom((unsigned)time(NULL));
+    access_count = 0;
+    address_rejected = 0;
+    page_faults = 0;
+    dirty_pages_written = 0;
+    next_free_frame = 0;
+    fifo_next_frame = 0;
+    clock_pointer = 0;
 
     physical_memory = (Frame *)malloc(num_frames * sizeof(Frame));
-    page_table = (PageTableEntry *)malloc(MAX_PAGE_TABLE_SIZE * sizeof(PageTableEntry));
 
-    if (!physical_memory || !page_table) {
+    // Uma entrada por página do espaço de 32 bits: 2^21 entradas (8 MB) com páginas de 2 KB,
+    // 2^16 (256 KB) com páginas de 64 KB. O mapeamento anônimo já vem zerado (todas as entradas
+    // inválidas) e só ocupa memória física nas páginas da tabela que o trace realmente toca
+    page_table_bytes = ((size_t)1 << (ADDRESS_BITS - s)) * sizeof(PageTableEntry);
+    page_table = (PageTableEntry *)mmap(NULL, page_table_bytes, PROT_READ | PROT_WRITE,
+                                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+    if (!physical_memory || page_table == MAP_FAILED) {
         fprintf(stderr, "Erro ao alocar memória para o simulador\n");
         exit(EXIT_FAILURE);
     }
 
     for (unsigned i = 0; i < num_frames; i++) {
-        physical_memory[i].valid = FALSE;
-        physical_memory[i].modified = FALSE;
         physical_memory[i].page_number = -1;
-        physical_memory[i].reference = 0;
     }
 
-    for (unsigned i = 0; i < MAX_PAGE_TABLE_SIZE; i++) {
-        page_table[i].valid = FALSE;
+    if (policy_id == POLICY_LRU) {
+        lru_init(&lru_list, num_frames);
+    }
+    if (sim_policy_uses_repl(policy_id)) {
+        repl_init(&repl, policy_id - POLICY_ARC, num_frames);
+    }
+}
+
+// Libera as estruturas da simulação; os totais continuam disponíveis para o relatório
+static void release_simulator() {
+    free(physical_memory);
+    munmap(page_table, page_table_bytes);
+    physical_memory = NULL;
+    page_table = NULL;
+    if (policy_id == POLICY_LRU) {
+        lru_free(&lru_list);
+    }
+    if (sim_policy_uses_repl(policy_id)) {
+        repl_free(&repl);
+    }
+    if (policy_id == POLICY_OPT) {
+        opt_free(&opt);
+    }
+    tlb_free(&tlb);
+}
+
+// Bytes da tabela que o trace chegou a tocar: do mapeamento reservado, só essas páginas ocupam
+// memória. Sem mincore, o mapeamento inteiro
+static size_t resident_table_bytes() {
+
+    size_t system_page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t pages = (page_table_bytes + system_page - 1) / system_page;
+    unsigned char *vector = (unsigned char *)malloc(pages);
+    if (!vector || mincore(page_table, page_table_bytes, vector) != 0) {
+        free(vector);
+        return page_table_bytes;
+    }
+
+    size_t resident = 0;
+    for (size_t i = 0; i < pages; i++) {
+        resident += vector[i] & 1;
+    }
+    free(vector);
+    return resident * system_page;
+}
+
+// Laço de acessos, instanciado uma vez por política por SIM_DEFINE_KERNELS.
+// Os acessos seguidos à mesma página depois do primeiro são aplicados de uma vez
+SIM_INLINE void simulate_accesses(TraceReader *trace, const int policy) {
+    uint64_t addr;
+    char rw;
+    unsigned long repeats;
+    int repeats_written;
+    while (PROF_TIME(PROF_PARSE, trace_next_run(trace, s, &addr, &rw, writeback_run_limit(&writeback, access_count),
+                                                &repeats, &repeats_written))) {
+        if (addr >> ADDRESS_BITS) {
+            reject_address(addr);
+            break;
+        }
+        if (shards_skip(&shards, addr >> s, repeats)) {
+            continue;
+        }
+        TlbEntry *cached = process_memory_access(addr, rw, policy);
+        if (repeats) {
+            repeat_page_access(addr >> s, cached, repeats, repeats_written, policy);
+        }
+        // O próximo uso da página é o do último acesso da sequência
+        if (policy == POLICY_OPT) {
+            opt_touch(&opt, pte_frame(page_table[addr >> s]), trace->position - 1);
+        }
+        if (writeback_due(&writeback, access_count)) {
+            run_writeback();
+        }
+        if (series_due(&series, access_count + shards.skipped_accesses)) {
+            record_window();
+        }
     }
 }
 
-//Simula a execução de um acesso à memória com uma dada função (leitura ou escrita)
-void process_memory_access(unsigned addr, char rw) {
+//Simula a execução de um acesso à memória com uma dada função (leitura ou escrita).
+// Devolve a entrada da TLB com a tradução da página (NULL sem TLB)
+SIM_INLINE TlbEntry *process_memory_access(unsigned addr, char rw, const int policy) {
 
     int page_number = addr >> s;
     access_count++;
-    int frame_index = find_page_in_memory(page_number);
+    PageTableEntry needed_bits = PTE_REFERENCED | (rw == 'W' ? PTE_DIRTY : 0);
+
+    // Acerto na TLB: não consulta a tabela. Como na MMU, a entrada só é escrita para ligar os
+    // bits de referenciada/suja que a TLB ainda não sabe que estão ligados
+    PROF_START(lookup);
+    if (tlb_enabled(&tlb)) {
+        TlbEntry *cached = tlb_lookup(&tlb, page_number);
+        if (cached) {
+            PROF_STOP(PROF_LOOKUP, lookup);
+            if ((cached->bits & needed_bits) != needed_bits) {
+                set_entry_bits(&page_table[page_number], needed_bits);
+                cached->bits |= needed_bits;
+            }
+            if (policy == POLICY_LRU) {
+                lru_touch(&lru_list, cached->frame);
+            } else if (sim_policy_uses_repl(policy)) {
+                repl_hit(&repl, cached->frame);
+            }
+            return cached;
+        }
+    }
 
-    if (frame_index == -1) {
+    // O percurso da tabela densa é a leitura de uma entrada
+    PageTableEntry *entry = &page_table[page_number];
+    int present = pte_valid(*entry);
+    PROF_COUNT(PROF_WALKS, 1);
+    PROF_COUNT(PROF_WALK_LEVELS, 1);
+    PROF_STOP(PROF_LOOKUP, lookup);
+
+    if (!present) {
         page_faults++;
-        handle_page_fault(page_number, rw);
+        PROF_CALL(PROF_FAULT, handle_page_fault(page_number, rw, policy));
     } else {
 
-        physical_memory[frame_index].valid = TRUE;
-        physical_memory[frame_index].reference = 1;
-        if (rw == 'W') {
-            physical_memory[frame_index].modified = TRUE;
+        int frame_index = pte_frame(*entry);
+        set_entry_bits(entry, needed_bits);
+        if (policy == POLICY_LRU) {
+            lru_touch(&lru_list, frame_index);
+        } else if (sim_policy_uses_repl(policy)) {
+            repl_hit(&repl, frame_index);
         }
-        page_table[page_number].last_access_time = access_count;
     }
+
+    if (tlb_enabled(&tlb)) {
+        return tlb_insert(&tlb, page_number, pte_frame(*entry), *entry & (PTE_REFERENCED | PTE_DIRTY));
+    }
+    return NULL;
 }
 
-// Encontra uma página na memória
-int find_page_in_memory(int page_number) {
-    for (unsigned i = 0; i < num_frames; i++) {
-        if (physical_memory[i].valid && physical_memory[i].page_number == page_number) {
-            return i;
-        }
+// Acessos que seguem o primeiro na mesma página, já presente: todos são acertos, então basta
+// ligar os bits, avançar o contador e mover o quadro na recência uma vez (na TLB, se houver)
+SIM_INLINE void repeat_page_access(int page_number, TlbEntry *cached, unsigned long repeats, int written, const int policy) {
+
+    PageTableEntry bits = PTE_REFERENCED | (written ? PTE_DIRTY : 0);
+    int frame_index = pte_frame(page_table[page_number]);
+
+    access_count += repeats;
+    set_entry_bits(&page_table[page_number], bits);
+    if (policy == POLICY_LRU) {
+        lru_touch(&lru_list, frame_index);
+    } else if (sim_policy_uses_repl(policy)) {
+        repl_hits(&repl, frame_index, repeats);
+    }
+
+    if (cached) {
+        tlb_repeat_hits(&tlb, cached, repeats);
+        cached->bits |= bits;
     }
-    return -1;
 }
 
 // Lida com a falta de uma página na memória
-void handle_page_fault(int page_number, char rw) {
-    int victim_frame = select_victim_frame();
+SIM_INLINE void handle_page_fault(int page_number, char rw, const int policy) {
+    int victim_frame = PROF_TIME(PROF_EVICT, select_victim_frame(page_number, policy));
+    Frame *frame = &physical_memory[victim_frame];
+
+    if (frame->page_number != -1) {
+        PROF_COUNT(PROF_VICTIM_SEARCHES, 1);
+        if (tlb_enabled(&tlb)) {
+            tlb_invalidate(&tlb, frame->page_number);
+        }
+        int dirty = (page_table[frame->page_number] & PTE_DIRTY) != 0;
+        if (dirty) {
+            dirty_pages_written++;
+        }
+        writeback_evicted(&writeback, dirty);
+        page_table[frame->page_number] = 0;
+    }
 
-    if (physical_memory[victim_frame].valid) {
-    page_table[physical_memory[victim_frame].page_number].valid = FALSE;
+    frame->page_number = page_number;
+
+    page_table[page_number] = pte_make(victim_frame) | (rw == 'W' ? PTE_DIRTY : 0);
+    writeback_dirtied(&writeback, rw == 'W');
+    if (policy == POLICY_LRU) {
+        lru_touch(&lru_list, victim_frame);
+    }
+}
+
+// Liga os bits na entrada de uma página presente, contando a que passa a estar suja
+SIM_INLINE void set_entry_bits(PageTableEntry *entry, PageTableEntry bits) {
+    PageTableEntry old = *entry;
+    *entry = old | bits;
+    writeback_dirtied(&writeback, (bits & ~old & PTE_DIRTY) != 0);
 }
 
-    if (physical_memory[victim_frame].valid && physical_memory[victim_frame].modified) {
-        dirty_pages_written++;
+// Rodada do limpador: escreve as páginas sujas dos quadros a partir do ponteiro dele. Como a TLB
+// guarda o bit de suja, limpar a entrada derruba a tradução, senão a próxima escrita não voltaria
+// a sujar a página
+static void run_writeback() {
+    PROF_START(start);
+    unsigned pending = writeback_begin(&writeback, access_count);
+    for (unsigned step = 0; pending > 0 && step < num_frames; step++) {
+        unsigned index = writeback.hand;
+        writeback.hand = index + 1 == num_frames ? 0 : index + 1;
+
+        int page_number = physical_memory[index].page_number;
+        if (page_number != -1 && (page_table[page_number] & PTE_DIRTY)) {
+            page_table[page_number] &= ~PTE_DIRTY;
+            if (tlb_enabled(&tlb)) {
+                tlb_invalidate(&tlb, page_number);
+            }
+            dirty_pages_written++;
+            writeback_cleaned(&writeback);
+            pending--;
+        }
     }
+    PROF_STOP(PROF_WRITEBACK, start);
+}
+
+// Contadores acumulados da série por janelas, no tempo do trace (com os acessos fora da amostra)
+static SeriesSample window_sample() {
+    SeriesSample sample = {access_count + shards.skipped_accesses, access_count, page_faults, dirty_pages_written, writeback.dirty};
+    return sample;
+}
 
-    physical_memory[victim_frame].page_number = page_number;
-    physical_memory[victim_frame].valid = TRUE;
-    physical_memory[victim_frame].modified = (rw == 'W');
+// Fim de uma janela da série
+static void record_window() {
+    SeriesSample sample = window_sample();
+    series_record(&series, &sample);
+}
 
-    page_table[page_number].frame_number = victim_frame;
-    page_table[page_number].valid = TRUE;
-    page_table[page_number].last_access_time = access_count;
+// Endereço que não cabe nos 32 bits da tabela densa: a simulação para com erro em vez de
+// truncá-lo, o que juntaria páginas diferentes numa só
+static void reject_address(uint64_t addr) {
+    fprintf(stderr, "Endereço 0x%llx fora dos %d bits da tabela densa: use quatroNiveis ou inverted\n",
+            (unsigned long long)addr, ADDRESS_BITS);
+    address_rejected = 1;
 }
 
 // Algoritmos de seleção de página a ser retirada da memória
-int select_victim_frame() {
+SIM_INLINE int select_victim_frame(int page_number, const int policy) {
 
-    for (unsigned i = 0; i < num_frames; i++) {
-        if (!physical_memory[i].valid) {
-            return i;
-        }
+    // As políticas de repl.c e a opt escolhem também entre os quadros livres, que entregam na mesma ordem
+    if (sim_policy_uses_repl(policy)) {
+        return repl_miss(&repl, page_number);
+    }
+    if (policy == POLICY_OPT) {
+        return opt_victim(&opt);
+    }
+
+    // Quadros nunca são liberados, então os livres são sempre os de índice >= next_free_frame
+    if (next_free_frame < num_frames) {
+        return next_free_frame++;
     }
 
-    if (strcmp(replacement_policy, "random") == 0) {
-        return random() % num_frames;
+    switch (policy) {
+    case POLICY_RANDOM:
+        return sim_random_next(&rng) % num_frames;
 
-    } else if (strcmp(replacement_policy, "fifo") == 0) {
-        static int next_frame = 0;
-        int victim = next_frame;
-        next_frame = (next_frame + 1) % num_frames;
+    case POLICY_FIFO: {
+        int victim = fifo_next_frame;
+        fifo_next_frame = (fifo_next_frame + 1) % num_frames;
         return victim;
-        
-    } else if (strcmp(replacement_policy, "lru") == 0) {
-        unsigned long oldest_time = ~0UL;
-        int victim = -1;
-
-        for (unsigned i = 0; i < num_frames; i++) {
-            if (physical_memory[i].valid) {
-                unsigned page_number = physical_memory[i].page_number;
-                unsigned long last_access = page_table[page_number].last_access_time;
-
-                if (last_access < oldest_time) {
-                    oldest_time = last_access;
-                    victim = i;
+    }
+
+    case POLICY_LRU:
+        // A cauda da lista de recência é o quadro usado há mais tempo: a falta e os acertos o levam para a cabeça
+        return lru_victim(&lru_list);
+
+    case POLICY_2A:
+        while (TRUE) {
+            int victim = clock_pointer;
+            clock_pointer = (clock_pointer + 1) % num_frames;
+
+            // O relógio só anda com todos os quadros ocupados, então a página existe
+            PageTableEntry *entry = &page_table[physical_memory[victim].page_number];
+            if (!(*entry & PTE_REFERENCED)) {
+                return victim;
+            } else {
+                // A TLB não pode continuar achando que o bit está ligado
+                *entry &= ~PTE_REFERENCED;
+                PROF_COUNT(PROF_SKIPPED_FRAMES, 1);
+                if (tlb_enabled(&tlb)) {
+                    tlb_invalidate(&tlb, physical_memory[victim].page_number);
                 }
             }
         }
-
-        return victim;
-        
-    } else if (strcmp(replacement_policy, "2a") == 0) {
-    static int pointer = 0;
-    while (TRUE) {
-        int victim = pointer;
-        pointer = (pointer + 1) % num_frames;
-
-        if (physical_memory[victim].reference == 0) {
-            return victim;
-        } else {
-            physical_memory[victim].reference = 0;
-        }
     }
-}
     return 0;
 }
 
-void print_report(const char *input_file) {
+static void print_report(const char *input_file) {
 
     //printf("Memória gasta = %d KB\n", MAX_PAGE_TABLE_SIZE / 128);
     printf("Executando o simulador...\n");
@@ -239,7 +514,16 @@ void print_report(const char *input_file) {
     printf("Tamanho da memoria: %u KB\n", memory_size / 1024);
     printf("Tamanho das páginas: %u KB\n", page_size / 1024);
     printf("Tecnica de reposicao: %s\n", replacement_policy);
-    printf("Paginas lidas: %lu\n", page_faults);
-    printf("Paginas escritas: %lu\n", dirty_pages_written);
-    printf("Total de acessos à memória: %lu\n", access_count);
+    printf("Paginas lidas: %lu\n", shards_estimate(&shards, page_faults));
+    printf("Paginas escritas: %lu\n", shards_estimate(&shards, dirty_pages_written));
+    printf("Total de acessos à memória: %lu\n", access_count + shards.skipped_accesses);
+    shards_print_stats(&shards, access_count);
+    writeback_print_stats(&writeback);
+    tlb_print_stats(&tlb);
+    if (sim_policy_uses_repl(policy_id)) {
+        repl_print_stats(&repl);
+    }
+    if (policy_id == POLICY_OPT) {
+        opt_print_stats(&opt);
+    }
 }
\ No newline at end of file
@@ -2,6 +2,21 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <stddef.h>
+
+#include "frames.h"
+#include "lru.h"
+#include "opt.h"
+#include "prof.h"
+#include "pte.h"
+#include "pwc.h"
+#include "repl.h"
+#include "series.h"
+#include "shards.h"
+#include "slab.h"
+#include "trace.h"
+#include "writeback.h"
+#include "sim.h"
 
 // Constantes globais
 #define MAX_ADDRESS_BITS 32
@@ -9,45 +24,60 @@
 #define WRITE 'W'
 
 // Estruturas de dados
-typedef struct PageTableEntry {
-    int frame;
-    int valid;
-    int modified;
-    int referenced;
-    unsigned timestamp;
-} PageTableEntry;
+// As entradas da tabela são PageTableEntry compactas (pte.h); aqui só o quadro e o bit de válida
+// são usados, já que suja e referenciada ficam no quadro
+// Tabela do segundo nível, alocada do slab: conta as entradas válidas para voltar à lista livre
+// quando a última página dela for despejada, e guarda a posição do primeiro nível que aponta
+// para ela, para ser desligada sem percorrer a tabela de novo
+typedef struct PageTableLeaf {
+    struct PageTableLeaf **slot;
+    unsigned live;
+    PageTableEntry entries[];
+} PageTableLeaf;
 
 typedef struct PageTableLevel {
-    PageTableEntry **entries;
+    PageTableLeaf **entries;
     unsigned size;
 } PageTableLevel;
 
 // Variáveis globais
-unsigned page_offset_bits;
-unsigned level1_bits, level2_bits;
-PageTableLevel *level1_table;
-unsigned memory_size_kb;
-unsigned page_size_kb;
-char replacement_policy[10];
-long unsigned total_accesses = 0;
-long unsigned page_faults = 0;
-unsigned pages_written = 0;
-
-// Estrutura para representar os quadros de memória
-typedef struct Frame {
-    int page_number;
-    int valid;
-    int modified;
-    int referenced;
-    unsigned last_access;
-} Frame;
-
-Frame *physical_memory;
-unsigned num_frames;
-unsigned current_time = 0;
+static _Thread_local unsigned page_offset_bits;
+static _Thread_local unsigned level1_bits, level2_bits;
+static _Thread_local PageTableLevel *level1_table;
+static _Thread_local Slab leaf_slab;
+static _Thread_local size_t page_table_bytes = 0;
+static _Thread_local size_t peak_page_table_bytes = 0;
+static _Thread_local unsigned memory_size_kb;
+static _Thread_local unsigned page_size_kb;
+static _Thread_local char replacement_policy[10];
+static _Thread_local long unsigned total_accesses = 0;
+static _Thread_local long unsigned page_faults = 0;
+static _Thread_local unsigned pages_written = 0;
+static _Thread_local long unsigned page_table_walks = 0;
+
+// Cache de percurso: guarda tabelas do segundo nível pelo índice do primeiro
+static _Thread_local PwcLevel leaf_cache;
+
+// Quadros de memória em estrutura de vetores (frames.h); frame_entries guarda a entrada da página
+// contida em cada quadro, para o despejo não percorrer a tabela
+static _Thread_local FrameTable frames;
+static _Thread_local PageTableEntry **frame_entries;
+static _Thread_local unsigned num_frames;
+static _Thread_local LruList lru_list;
+static _Thread_local SimRandom rng;
+static _Thread_local unsigned fifo_next_frame = 0;
+static _Thread_local unsigned clock_pointer = 0;
+static _Thread_local int policy_id;
+static _Thread_local Tlb tlb;
+static _Thread_local Repl repl;
+static _Thread_local Opt opt;
+static _Thread_local Writeback writeback;
+static _Thread_local Shards shards;
+static _Thread_local Series series;
+static _Thread_local int address_rejected;
 
 // Funções auxiliares
-unsigned calculate_offset_bits(unsigned page_size_kb) {
+static unsigned calculate_offset_bits(unsigned page_size_kb) {
     unsigned tmp = page_size_kb;
     unsigned s = 0;
     while (tmp > 1) {
@@ -58,212 +88,482 @@ unsigned calculate_offset_bits(unsigned page_size_kb) {
 }
 
 // Calcula os bits de offset para 2 hierarquias
-unsigned calculate_level_bits(unsigned total_bits, unsigned offset_bits) {
+static unsigned calculate_level_bits(unsigned total_bits, unsigned offset_bits) {
     return (total_bits - offset_bits) / 2;
 }
 
 // Inicializar a memória física e tabela de páginas
-void initialize_page_table() {
+static void initialize_page_table() {
 
     level1_table = (PageTableLevel *)malloc(sizeof(PageTableLevel));
     level1_table->size = (1 << level1_bits);
-    level1_table->entries = (PageTableEntry **)calloc(level1_table->size, sizeof(PageTableEntry *));
+    level1_table->entries = (PageTableLeaf **)calloc(level1_table->size, sizeof(PageTableLeaf *));
+    slab_init(&leaf_slab, sizeof(PageTableLeaf) + (1 << level2_bits) * sizeof(PageTableEntry));
+
+    page_table_bytes = sizeof(PageTableLevel) + level1_table->size * sizeof(PageTableLeaf *);
+    peak_page_table_bytes = page_table_bytes;
+
+    num_frames = shards_frames(&shards, memory_size_kb / page_size_kb);
+    frames_init(&frames, num_frames);
+    frame_entries = (PageTableEntry **)frames_alloc_array(num_frames, sizeof(PageTableEntry *));
+
+    total_accesses = 0;
+    address_rejected = 0;
+    page_faults = 0;
+    pages_written = 0;
+    page_table_walks = 0;
+    fifo_next_frame = 0;
+    clock_pointer = 0;
+
+    if (policy_id == POLICY_LRU) {
+        lru_init(&lru_list, num_frames);
+    }
+    if (sim_policy_uses_repl(policy_id)) {
+        repl_init(&repl, policy_id - POLICY_ARC, num_frames);
+    }
+}
+
+// Libera a tabela de páginas e os quadros; os totais continuam disponíveis para o relatório
+static void release_page_table() {
+
+    slab_destroy(&leaf_slab);
+    free(level1_table->entries);
+    free(level1_table);
+    level1_table = NULL;
+
+    frames_free(&frames);
+    free(frame_entries);
+    frame_entries = NULL;
+
+    if (policy_id == POLICY_LRU) {
+        lru_free(&lru_list);
+    }
+    if (sim_policy_uses_repl(policy_id)) {
+        repl_free(&repl);
+    }
+    if (policy_id == POLICY_OPT) {
+        opt_free(&opt);
+    }
+    tlb_free(&tlb);
+    pwc_free(&leaf_cache);
+}
+
+static PageTableLeaf *alloc_leaf() {
+    PageTableLeaf *leaf = (PageTableLeaf *)slab_alloc(&leaf_slab);
+    page_table_bytes += leaf_slab.block_size;
+    if (page_table_bytes > peak_page_table_bytes) {
+        peak_page_table_bytes = page_table_bytes;
+    }
+    return leaf;
+}
 
-    num_frames = memory_size_kb / page_size_kb;
-    physical_memory = (Frame *)calloc(num_frames, sizeof(Frame));
+static void free_leaf(PageTableLeaf *leaf) {
+    slab_free(&leaf_slab, leaf);
+    page_table_bytes -= leaf_slab.block_size;
 }
 
-PageTableEntry *get_or_create_page_entry(unsigned virtual_address) {
+// Tabela do segundo nível do endereço, lida do primeiro nível e criada se faltar.
+// É o caminho lento do percurso, fora do laço: só roda quando o cache de percurso não tem a tabela
+static PageTableLeaf *walk_level1(unsigned virtual_address) {
 
     unsigned level1_index = (virtual_address >> level2_bits) & ((1 << level1_bits) - 1);
-    unsigned level2_index = virtual_address & ((1 << level2_bits) - 1);
+    PROF_COUNT(PROF_WALK_LEVELS, 1);
 
     if (level1_table->entries[level1_index] == NULL) {
-        level1_table->entries[level1_index] = (PageTableEntry *)calloc((1 << level2_bits), sizeof(PageTableEntry));
+        PageTableLeaf *leaf = alloc_leaf();
+        leaf->slot = &level1_table->entries[level1_index];
+        level1_table->entries[level1_index] = leaf;
     }
 
-    return &level1_table->entries[level1_index][level2_index];
+    PageTableLeaf *leaf = level1_table->entries[level1_index];
+    pwc_fill(&leaf_cache, level1_index, leaf);
+    return leaf;
+}
+
+// Entrada da página, criando a tabela do segundo nível se preciso; devolve também essa tabela.
+// É o único percurso da tabela: page_table_walks conta um por acesso que não acerta na TLB.
+// Com acerto no cache de percurso o percurso lê só a entrada da página
+SIM_INLINE PageTableEntry *get_or_create_page_entry(unsigned virtual_address, PageTableLeaf **leaf_out) {
+
+    page_table_walks++;
+    PROF_COUNT(PROF_WALKS, 1);
+    PROF_COUNT(PROF_WALK_LEVELS, 1);
+
+    PageTableLeaf *leaf = (PageTableLeaf *)pwc_lookup(&leaf_cache, (virtual_address >> level2_bits) & ((1 << level1_bits) - 1));
+    if (!leaf) {
+        leaf = walk_level1(virtual_address);
+    }
+
+    *leaf_out = leaf;
+    return &leaf->entries[virtual_address & ((1 << level2_bits) - 1)];
+}
+
+// Invalida a entrada da página contida no quadro, chegando a ela e à sua tabela pelo próprio
+// quadro; a tabela que fica vazia volta para o slab e sai do cache de percurso
+static void invalidate_frame_entry(int frame_index) {
+
+    PageTableEntry *entry = frame_entries[frame_index];
+    unsigned level2_index = frames.page_number[frame_index] & ((1 << level2_bits) - 1);
+    PageTableLeaf *leaf = (PageTableLeaf *)((char *)(entry - level2_index) - offsetof(PageTableLeaf, entries));
+
+    *entry = 0;
+    frame_entries[frame_index] = NULL;
+    if (--leaf->live == 0) {
+        *leaf->slot = NULL;
+        leaf->slot = NULL;
+        free_leaf(leaf);
+        pwc_forget(&leaf_cache, (frames.page_number[frame_index] >> level2_bits) & ((1 << level1_bits) - 1));
+    }
 }
 
 // Algoritmos de seleção de página a ser retirada da memória
-int choose_frame_to_replace() {
-    if (strcmp(replacement_policy, "lru") == 0) {
-        
-        unsigned lru_frame = 0;
-        unsigned oldest_time = physical_memory[0].last_access;
-        for (unsigned i = 1; i < num_frames; i++) {
-            if (physical_memory[i].last_access < oldest_time) {
-                oldest_time = physical_memory[i].last_access;
-                lru_frame = i;
-            }
-        }
-        return lru_frame;
-        
-    } else if (strcmp(replacement_policy, "fifo") == 0) {
-        static int next_frame = 0;
-        int victim = next_frame;
-        next_frame = (next_frame + 1) % num_frames;
+SIM_INLINE int choose_frame_to_replace(unsigned page, const int policy) {
+    switch (policy) {
+    case POLICY_LRU:
+        // A cauda da lista de recência é a vítima, também com quadros livres. Só os acertos levam
+        // o quadro para a cabeça: a carga numa falta não o move, então ele fica na cauda até o
+        // primeiro acerto
+        return lru_victim(&lru_list);
+
+    case POLICY_FIFO: {
+        int victim = fifo_next_frame;
+        fifo_next_frame = (fifo_next_frame + 1) % num_frames;
         return victim;
+    }
 
-    } else if (strcmp(replacement_policy, "random") == 0) {
-        return rand() % num_frames;
+    case POLICY_RANDOM:
+        return sim_random_next(&rng) % num_frames;
 
-    } else if (strcmp(replacement_policy, "2a") == 0) {
-        static int pointer = 0;
-        while (1) {
-            int victim = pointer;
-            pointer = (pointer + 1) % num_frames;
+    case POLICY_2A:
+        return frames_clock_victim(&frames, &clock_pointer);
 
+    case POLICY_OPT:
+        return opt_victim(&opt);
 
-            if (physical_memory[victim].referenced == 0) {
-                return victim;
-            } else {
-                physical_memory[victim].referenced = 0;
-            }
-        }
-    } else {
-        fprintf(stderr, "Algoritmo de substituição desconhecido: %s\n", replacement_policy);
-        exit(1);
+    default:
+        // Políticas de repl.c: escolhem também entre os quadros livres
+        return repl_miss(&repl, page);
     }
-    return 0;
 }
 
 //Lida com a falta de uma página na memória
-void handle_page_fault(PageTableEntry *entry, unsigned virtual_address, char rw) {
+SIM_INLINE void handle_page_fault(PageTableEntry *entry, PageTableLeaf *leaf, unsigned virtual_address, char rw, const int policy) {
+
+    // Conta a nova entrada antes do despejo: se a vítima for da mesma tabela, ela não pode ser liberada
+    leaf->live++;
 
-    int frame_to_replace = choose_frame_to_replace();
+    int frame_to_replace = PROF_TIME(PROF_EVICT, choose_frame_to_replace(virtual_address, policy));
 
-    if (physical_memory[frame_to_replace].valid) {
-        unsigned old_virtual_page = physical_memory[frame_to_replace].page_number;
-        PageTableEntry *old_entry = get_or_create_page_entry(old_virtual_page);
-        old_entry->valid = 0;
+    if (frames.valid[frame_to_replace]) {
+        PROF_COUNT(PROF_VICTIM_SEARCHES, 1);
+        if (tlb_enabled(&tlb)) {
+            tlb_invalidate(&tlb, frames.page_number[frame_to_replace]);
+        }
+        invalidate_frame_entry(frame_to_replace);
     }
     
-    if (physical_memory[frame_to_replace].valid && physical_memory[frame_to_replace].modified) {
-        pages_written++;
+    if (frames.valid[frame_to_replace]) {
+        if (frames.modified[frame_to_replace]) {
+            pages_written++;
+        }
+        writeback_evicted(&writeback, frames.modified[frame_to_replace]);
     }
 
-    physical_memory[frame_to_replace].page_number = virtual_address;
+    frames.page_number[frame_to_replace] = virtual_address;
     
-    physical_memory[frame_to_replace].valid = 1;
-    physical_memory[frame_to_replace].modified = 0;
+    frames.valid[frame_to_replace] = 1;
+    frames.modified[frame_to_replace] = 0;
+
+    frame_entries[frame_to_replace] = entry;
 
-    entry->frame = frame_to_replace;
-    entry->valid = 1;
+    *entry = pte_make(frame_to_replace);
 }
 
-void print_inverted_table() {
+SIM_UNUSED static void print_inverted_table() {
     printf("Tabela Invertida:\n");
     printf("-------------------------------------------------\n");
     printf("| Quadro | Página Virtual | Suja | Referenciada |\n");
     printf("-------------------------------------------------\n");
     for (unsigned i = 0; i < num_frames; i++) {
-        printf("| %-6u | %-14d | %-4d | %-12d |\n",
+        printf("| %-6u | %-14llu | %-4d | %-12d |\n",
                i,
-               physical_memory[i].page_number,
-               physical_memory[i].modified,
-               physical_memory[i].referenced);
+               (unsigned long long)frames.page_number[i],
+               frames.modified[i],
+               frames.referenced[i]);
     }
     printf("-------------------------------------------------\n");
 }
 
-// Processamento do arquivo de entrada
-void process_memory_access(FILE *file) {
-    unsigned address;
-    char access_type;
+// Liga o bit de suja do quadro, contando a página que passa a estar suja
+SIM_INLINE void mark_modified(int frame_index, int written) {
+    uint8_t was_modified = frames.modified[frame_index];
+    frames.modified[frame_index] = was_modified | (written != 0);
+    writeback_dirtied(&writeback, (written != 0) & !was_modified);
+}
 
-    while (fscanf(file, "%x %c", &address, &access_type) != EOF) {
+// Rodada do limpador: escreve as páginas sujas dos quadros a partir do ponteiro dele. O bit de
+// suja fica no quadro, não na TLB, então as traduções continuam valendo
+SIM_COLD static void run_writeback() {
+    PROF_START(start);
+    unsigned pending = writeback_begin(&writeback, total_accesses);
+    for (unsigned step = 0; pending > 0 && step < num_frames; step++) {
+        unsigned index = writeback.hand;
+        writeback.hand = index + 1 == num_frames ? 0 : index + 1;
+
+        if (frames.valid[index] && frames.modified[index]) {
+            frames.modified[index] = 0;
+            pages_written++;
+            writeback_cleaned(&writeback);
+            pending--;
+        }
+    }
+    PROF_STOP(PROF_WRITEBACK, start);
+}
+
+// Contadores acumulados da série por janelas, no tempo do trace (com os acessos fora da amostra)
+static SeriesSample window_sample() {
+    SeriesSample sample = {total_accesses + shards.skipped_accesses, total_accesses, page_faults, pages_written, writeback.dirty};
+    return sample;
+}
+
+// Fim de uma janela da série
+SIM_COLD static void record_window() {
+    SeriesSample sample = window_sample();
+    series_record(&series, &sample);
+}
+
+// Endereço que não cabe nos 32 bits da tabela de dois níveis: a simulação para com erro em vez de
+// truncá-lo, o que juntaria páginas diferentes numa só
+SIM_COLD static void reject_address(uint64_t addr) {
+    fprintf(stderr, "Endereço 0x%llx fora dos %d bits da tabela de dois níveis: use quatroNiveis ou inverted\n",
+            (unsigned long long)addr, MAX_ADDRESS_BITS);
+    address_rejected = 1;
+}
+
+// hits acessos seguidos a uma página presente
+SIM_INLINE void reference_frame(int frame_index, unsigned long hits, const int policy) {
+    frames.referenced[frame_index] = 1;
+    if (policy == POLICY_LRU) {
+        lru_touch(&lru_list, frame_index);
+    } else if (sim_policy_uses_repl(policy)) {
+        repl_hits(&repl, frame_index, hits);
+    }
+}
+
+// Processamento do arquivo de entrada, instanciado uma vez por política por SIM_DEFINE_KERNELS.
+// Os acessos seguidos à mesma página depois do primeiro são acertos e são aplicados de uma vez
+SIM_INLINE void process_memory_access(TraceReader *file, const int policy) {
+    uint64_t address;
+    char access_type;
+    unsigned long repeats;
+    int repeats_written;
+
+    while (PROF_TIME(PROF_PARSE, trace_next_run(file, page_offset_bits, &address, &access_type, writeback_run_limit(&writeback, total_accesses),
+                                                &repeats, &repeats_written))) {
+        if (address >> MAX_ADDRESS_BITS) {
+            reject_address(address);
+            break;
+        }
+        if (shards_skip(&shards, address >> page_offset_bits, repeats)) {
+            continue;
+        }
         total_accesses++;
-        current_time++;
        
         address = address >> page_offset_bits;
 
-        PageTableEntry *entry = get_or_create_page_entry(address);
-       
-        if (!entry->valid) {
-           
-            page_faults++;
-            handle_page_fault(entry, address, access_type);
+        // Acerto na TLB: usa o quadro guardado sem percorrer a tabela
+        PROF_START(lookup);
+        TlbEntry *cached = tlb_enabled(&tlb) ? tlb_lookup(&tlb, address) : NULL;
+        int frame_index;
+
+        if (cached) {
+            PROF_STOP(PROF_LOOKUP, lookup);
+            frame_index = cached->frame;
+            reference_frame(frame_index, 1, policy);
         } else {
 
-       
-        Frame *frame = &physical_memory[entry->frame];
-        frame->referenced = 1;
-        frame->last_access = current_time;
+            PageTableLeaf *leaf;
+            PageTableEntry *entry = get_or_create_page_entry(address, &leaf);
+            int present = pte_valid(*entry);
+            PROF_STOP(PROF_LOOKUP, lookup);
+            if (!present) {
 
-        }
-        Frame *frame = &physical_memory[entry->frame];
-        if (access_type == WRITE) {
-            frame->modified = 1;
-        }
-    }
-}
+                page_faults++;
+                PROF_CALL(PROF_FAULT, handle_page_fault(entry, leaf, address, access_type, policy));
+            } else {
+                reference_frame(pte_frame(*entry), 1, policy);
+            }
 
-// Função para calcular o tamanho da tabela - usada nos testes e no relatório
-void calculate_table_size() {
-    unsigned total_entries_used = 0;
-    unsigned total_level2_entries_used = 0;
+            frame_index = pte_frame(*entry);
+            if (tlb_enabled(&tlb)) {
+                cached = tlb_insert(&tlb, address, frame_index, 0);
+            }
+        }
 
-    for (unsigned i = 0; i < level1_table->size; i++) {
-        if (level1_table->entries[i] != NULL) {
-            total_entries_used++;
+        mark_modified(frame_index, access_type == WRITE);
 
-            PageTableEntry *level2_entries = level1_table->entries[i];
-            unsigned level2_count = 0;
+        if (repeats) {
+            total_accesses += repeats;
+            reference_frame(frame_index, repeats, policy);
+            mark_modified(frame_index, repeats_written);
 
-            for (unsigned j = 0; j < (1 << level2_bits); j++) {
-                if (level2_entries[j].valid) {
-                    level2_count++;
-                }
+            // Sem TLB cada repetição seria um percurso que acerta no cache de percurso
+            if (cached) {
+                tlb_repeat_hits(&tlb, cached, repeats);
+            } else {
+                page_table_walks += repeats;
+                pwc_repeat_hits(&leaf_cache, repeats);
             }
-            if (level2_count > 0)
-            total_level2_entries_used += 1;
+        }
 
+        // O próximo uso da página é o do último acesso da sequência
+        if (policy == POLICY_OPT) {
+            opt_touch(&opt, frame_index, file->position - 1);
+        }
+        if (writeback_due(&writeback, total_accesses)) {
+            run_writeback();
+        }
+        if (series_due(&series, total_accesses + shards.skipped_accesses)) {
+            record_window();
         }
     }
-
-    printf("Memória gasta = %d KB\n", 8 * (level1_table->size + (1 << level2_bits) * (total_level2_entries_used)) / 1024);
 }
 
+SIM_DEFINE_KERNELS(process_memory_access);
+
+// Memória da tabela de páginas (primeiro nível e tabelas do segundo nível em uso) e percursos
+// feitos nela - usada no relatório
+SIM_UNUSED static void calculate_table_size() {
+    printf("Memoria da tabela de paginas: %lu bytes (pico de %lu bytes)\n",
+           (unsigned long)page_table_bytes, (unsigned long)peak_page_table_bytes);
+    printf("Percursos da tabela de paginas: %lu (%lu em despejos)\n",
+           page_table_walks, page_table_walks - (total_accesses - tlb.hits));
+    if (leaf_cache.lookups) {
+        char leaf_rate[PWC_RATE_TEXT];
+        printf("Cache de percurso: nivel 1 com %s\n", pwc_hit_rate_text(&leaf_cache, leaf_rate));
+    }
+
+    // Cada percurso lê a entrada da página, e os que erram no cache leem também o primeiro nível
+    unsigned long memory_references = 2 * page_table_walks - leaf_cache.hits;
+    printf("Referencias a memoria por traducao: %.2f (%.2f por percurso, 2 sem o cache de percurso)\n",
+           total_accesses ? (double)memory_references / total_accesses : 0.0,
+           page_table_walks ? (double)memory_references / page_table_walks : 0.0);
+}
 
+#ifndef SIM_LIBRARY
 // Função principal
 int main(int argc, char *argv[]) {
-    if (argc != 5) {
-        fprintf(stderr, "Uso: %s <politica> <arquivo.log> <tamanho_pagina_kb> <tamanho_memoria_kb>\n", argv[0]);
+    if (argc < 5 || argc > 11) {
+        fprintf(stderr, "Uso: %s <politica> <arquivo.log> <tamanho_pagina_kb> <tamanho_memoria_kb> [tlb=entradas/vias/politica] [pwc=entradas] [wb=periodo/lote/fundo/limite] [shards=taxa/paginas] [prof=json|csv[:arquivo]] [series=janela[/csv|/bin][:arquivo]]\n", argv[0]);
         return 1;
     }
 
-    strncpy(replacement_policy, argv[1], sizeof(replacement_policy));
     const char *log_file = argv[2];
-    page_size_kb = atoi(argv[3]) * 1024;
-    memory_size_kb = atoi(argv[4]) * 1024;
 
-    page_offset_bits = calculate_offset_bits(page_size_kb);
-
-    level1_bits = calculate_level_bits(MAX_ADDRESS_BITS, page_offset_bits);
-    level2_bits = MAX_ADDRESS_BITS - page_offset_bits - level1_bits;
-
-    initialize_page_table();
-
-    FILE *file = fopen(log_file, "r");
-    if (!file) {
+    TraceReader file;
+    if (trace_open(&file, log_file) != 0) {
         perror("Erro ao abrir arquivo de log");
         return 1;
     }
 
-    process_memory_access(file);
-    fclose(file);
-
+    SimConfig config = {argv[1], atoi(argv[3]), atoi(argv[4]), SIM_DEFAULT_SEED, 0};
+    config.pwc_entries = SIM_DEFAULT_PWC_ENTRIES;
+    int invalid = sim_parse_options(argc, argv, 5, &config);
+    if (invalid) {
+        fprintf(stderr, "Opção inválida: %s\n", argv[invalid]);
+        return 1;
+    }
+    SimResult result;
+    if (doisNiveis_simulate(&config, &file, &result) != 0) {
+        return 1;
+    }
 
-    //calculate_table_size();
+    //Relatório final
     printf("Executando o simulador...\n");
     printf("Arquivo de entrada: %s\n", log_file);
     printf("Tamanho da memoria: %u KB\n", memory_size_kb / 1024);
     printf("Tamanho das paginas: %u KB\n", page_size_kb / 1024);
     printf("Tecnica de reposicao: %s\n", replacement_policy);
-    printf("Paginas lidas: %lu\n", page_faults);
-    printf("Paginas escritas: %u\n", pages_written);
-    printf("Total de acessos à memória: %lu\n", total_accesses);
+    printf("Paginas lidas: %lu\n", shards_estimate(&shards, page_faults));
+    printf("Paginas escritas: %lu\n", shards_estimate(&shards, pages_written));
+    printf("Total de acessos à memória: %lu\n", total_accesses + shards.skipped_accesses);
+    shards_print_stats(&shards, total_accesses);
+    writeback_print_stats(&writeback);
+    calculate_table_size();
+    tlb_print_stats(&tlb);
+    if (sim_policy_uses_repl(policy_id)) {
+        repl_print_stats(&repl);
+    }
+    if (policy_id == POLICY_OPT) {
+        opt_print_stats(&opt);
+    }
+    trace_print_stats(&file);
+    if (config.profile_format != PROF_FORMAT_NONE &&
+        prof_write(&sim_profile, config.profile_format, config.profile_path, "doisNiveis", argv[1], log_file, result.accesses) != 0) {
+        return 1;
+    }
+    trace_close(&file);
+
+    return 0;
+}
+#endif
+
+// Executa a simulação completa do trace (chamada pelo main e pelo sweep)
+int doisNiveis_simulate(const SimConfig *config, TraceReader *trace, SimResult *result) {
+
+    policy_id = sim_policy_id(config->policy);
+    if (policy_id < 0) {
+        fprintf(stderr, "Algoritmo de substituição desconhecido: %s\n", config->policy);
+        return -1;
+    }
+
+    strcpy(replacement_policy, config->policy);
+    page_size_kb = config->page_size_kb * 1024;
+    memory_size_kb = config->memory_kb * 1024;
+    if (shards_init(&shards, config->sample_rate, config->sample_budget, trace, calculate_offset_bits(page_size_kb)) != 0) {
+        return -1;
+    }
+    sim_random_seed(&rng, config->seed);
+    tlb_init(&tlb, config->tlb_entries, config->tlb_ways, config->tlb_policy);
+    pwc_init(&leaf_cache, config->pwc_entries);
+
+    page_offset_bits = calculate_offset_bits(page_size_kb);
+
+    level1_bits = calculate_level_bits(MAX_ADDRESS_BITS, page_offset_bits);
+    level2_bits = MAX_ADDRESS_BITS - page_offset_bits - level1_bits;
+
+    initialize_page_table();
+    writeback_init(&writeback, config->wb_period, config->wb_batch,
+                   config->wb_background_ratio, config->wb_dirty_ratio, num_frames);
+    if (policy_id == POLICY_OPT && opt_init(&opt, trace, page_offset_bits, num_frames) != 0) {
+        release_page_table();
+        return -1;
+    }
+
+    if (series_start(&series, config->series_window, config->series_format, config->series_path,
+                     shards.enabled ? shards.rate : 0) != 0) {
+        release_page_table();
+        return -1;
+    }
+
+    PROF_RUN_BEGIN();
+    kernels[policy_id](trace);
+    PROF_RUN_END();
+    SeriesSample last = window_sample();
+    if (series_finish(&series, &last) != 0 || address_rejected || trace->failed) {
+        release_page_table();
+        return -1;
+    }
+
+    result->page_faults = page_faults;
+    result->pages_written = pages_written;
+    result->accesses = total_accesses;
+    result->tlb_hits = tlb.hits;
+    result->ghost_hits = sim_policy_uses_repl(policy_id) ? repl.ghost_hits : 0;
+    result->page_table_bytes = peak_page_table_bytes;
+    sim_writeback_result(&writeback, result);
+    sim_shards_result(&shards, result);
 
+    release_page_table();
     return 0;
 }
@@ -0,0 +1,226 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "frames.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FRAMES_X86 1
+#endif
+
+// Kernels escalares, usados quando o processador não tem SSE4.1 e nas pontas dos vetoriais
+static int find_byte_scalar(const uint8_t *bytes, unsigned from, unsigned to, uint8_t value) {
+    for (unsigned i = from; i < to; i++) {
+        if (bytes[i] == value) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static int min_index_scalar(const uint32_t *values, unsigned count) {
+    if (count == 0) {
+        return -1;
+    }
+    unsigned best = 0;
+    for (unsigned i = 1; i < count; i++) {
+        if (values[i] < values[best]) {
+            best = i;
+        }
+    }
+    return (int)best;
+}
+
+static const FrameKernels frame_kernels_scalar = {"escalar", find_byte_scalar, min_index_scalar};
+
+#ifdef FRAMES_X86
+// Primeiro índice de [from, to) com values[i] == value
+static int find_u32_scalar(const uint32_t *values, unsigned from, unsigned to, uint32_t value) {
+    for (unsigned i = from; i < to; i++) {
+        if (values[i] == value) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+__attribute__((target("sse4.1")))
+static int find_byte_sse41(const uint8_t *bytes, unsigned from, unsigned to, uint8_t value) {
+    __m128i needle = _mm_set1_epi8((char)value);
+    unsigned i = from;
+    for (; i + 16 <= to; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i *)(bytes + i));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        if (mask) {
+            return (int)(i + __builtin_ctz(mask));
+        }
+    }
+    return find_byte_scalar(bytes, i, to, value);
+}
+
+// Duas passadas: o menor valor com min_epu32 e depois a primeira posição com ele
+__attribute__((target("sse4.1")))
+static int min_index_sse41(const uint32_t *values, unsigned count) {
+    if (count < 8) {
+        return min_index_scalar(values, count);
+    }
+
+    __m128i low = _mm_loadu_si128((const __m128i *)values);
+    unsigned i = 4;
+    for (; i + 4 <= count; i += 4) {
+        low = _mm_min_epu32(low, _mm_loadu_si128((const __m128i *)(values + i)));
+    }
+    low = _mm_min_epu32(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(1, 0, 3, 2)));
+    low = _mm_min_epu32(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(2, 3, 0, 1)));
+    uint32_t minimum = (uint32_t)_mm_cvtsi128_si32(low);
+    for (; i < count; i++) {
+        if (values[i] < minimum) {
+            minimum = values[i];
+        }
+    }
+
+    __m128i needle = _mm_set1_epi32((int)minimum);
+    for (i = 0; i + 4 <= count; i += 4) {
+        __m128i block = _mm_loadu_si128((const __m128i *)(values + i));
+        unsigned mask = (unsigned)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(block, needle)));
+        if (mask) {
+            return (int)(i + __builtin_ctz(mask));
+        }
+    }
+    return find_u32_scalar(values, i, count, minimum);
+}
+
+__attribute__((target("avx2")))
+static int find_byte_avx2(const uint8_t *bytes, unsigned from, unsigned to, uint8_t value) {
+    __m256i needle = _mm256_set1_epi8((char)value);
+    unsigned i = from;
+    for (; i + 32 <= to; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(bytes + i));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle));
+        if (mask) {
+            return (int)(i + __builtin_ctz(mask));
+        }
+    }
+    return find_byte_scalar(bytes, i, to, value);
+}
+
+__attribute__((target("avx2")))
+static int min_index_avx2(const uint32_t *values, unsigned count) {
+    if (count < 16) {
+        return min_index_scalar(values, count);
+    }
+
+    __m256i low = _mm256_loadu_si256((const __m256i *)values);
+    unsigned i = 8;
+    for (; i + 8 <= count; i += 8) {
+        low = _mm256_min_epu32(low, _mm256_loadu_si256((const __m256i *)(values + i)));
+    }
+    __m128i half = _mm_min_epu32(_mm256_castsi256_si128(low), _mm256_extracti128_si256(low, 1));
+    half = _mm_min_epu32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_min_epu32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    uint32_t minimum = (uint32_t)_mm_cvtsi128_si32(half);
+    for (; i < count; i++) {
+        if (values[i] < minimum) {
+            minimum = values[i];
+        }
+    }
+
+    __m256i needle = _mm256_set1_epi32((int)minimum);
+    for (i = 0; i + 8 <= count; i += 8) {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(values + i));
+        unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(block, needle)));
+        if (mask) {
+            return (int)(i + __builtin_ctz(mask));
+        }
+    }
+    return find_u32_scalar(values, i, count, minimum);
+}
+
+static const FrameKernels frame_kernels_sse41 = {"sse4.1", find_byte_sse41, min_index_sse41};
+static const FrameKernels frame_kernels_avx2 = {"avx2", find_byte_avx2, min_index_avx2};
+#endif
+
+int frames_supported_kernels(const FrameKernels **list, int max) {
+    int n = 0;
+    if (n < max) {
+        list[n++] = &frame_kernels_scalar;
+    }
+#ifdef FRAMES_X86
+    if (n < max && __builtin_cpu_supports("sse4.1")) {
+        list[n++] = &frame_kernels_sse41;
+    }
+    if (n < max && __builtin_cpu_supports("avx2")) {
+        list[n++] = &frame_kernels_avx2;
+    }
+#endif
+    return n;
+}
+
+const FrameKernels *frames_best_kernels() {
+    const FrameKernels *list[3];
+    int n = frames_supported_kernels(list, 3);
+    return list[n - 1];
+}
+
+void *frames_alloc_array(unsigned count, size_t element_size) {
+
+    // aligned_alloc exige um tamanho múltiplo do alinhamento
+    size_t bytes = ((size_t)count * element_size + FRAMES_ALIGNMENT - 1) / FRAMES_ALIGNMENT * FRAMES_ALIGNMENT;
+    if (bytes == 0) {
+        bytes = FRAMES_ALIGNMENT;
+    }
+
+    void *array = aligned_alloc(FRAMES_ALIGNMENT, bytes);
+    if (!array) {
+        fprintf(stderr, "Erro ao alocar memória para a tabela de quadros\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(array, 0, bytes);
+    return array;
+}
+
+void frames_init(FrameTable *frames, unsigned count) {
+    frames->count = count;
+    frames->page_number = (uint64_t *)frames_alloc_array(count, sizeof(uint64_t));
+    frames->valid = (uint8_t *)frames_alloc_array(count, sizeof(uint8_t));
+    frames->modified = (uint8_t *)frames_alloc_array(count, sizeof(uint8_t));
+    frames->referenced = (uint8_t *)frames_alloc_array(count, sizeof(uint8_t));
+    frames->kernels = frames_best_kernels();
+}
+
+void frames_free(FrameTable *frames) {
+    free(frames->page_number);
+    free(frames->valid);
+    free(frames->modified);
+    free(frames->referenced);
+    memset(frames, 0, sizeof(*frames));
+}
+
+int frames_clock_sweep(FrameTable *frames, unsigned *hand) {
+
+    unsigned start = *hand;
+    uint8_t *referenced = frames->referenced;
+
+    // Do ponteiro até o fim; se todos estiverem referenciados, do começo até o ponteiro.
+    // Se nenhum estiver livre, o relógio dá a volta inteira limpando os bits e para no início
+    int victim = frames->kernels->find_byte(referenced, start, frames->count, 0);
+    if (victim >= 0) {
+        memset(referenced + start, 0, victim - start);
+        PROF_COUNT(PROF_SKIPPED_FRAMES, victim - start);
+    } else {
+        memset(referenced + start, 0, frames->count - start);
+        victim = frames->kernels->find_byte(referenced, 0, start, 0);
+        if (victim >= 0) {
+            memset(referenced, 0, victim);
+            PROF_COUNT(PROF_SKIPPED_FRAMES, frames->count - start + victim);
+        } else {
+            memset(referenced, 0, start);
+            victim = (int)start;
+            PROF_COUNT(PROF_SKIPPED_FRAMES, frames->count);
+        }
+    }
+
+    *hand = ((unsigned)victim + 1) % frames->count;
+    return victim;
+}
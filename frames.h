@@ -0,0 +1,79 @@
+#ifndef FRAMES_H
+#define FRAMES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "prof.h"
+
+// Tabela de quadros em estrutura de vetores (um vetor por campo, cada um alinhado à linha de
+// cache), compartilhada por doisNiveis, tresNiveis, quatroNiveis e inverted. Uma varredura sobre
+// um campo (o ponteiro do relógio da segunda chance) lê só aquele vetor, em vez de arrastar os
+// quadros inteiros pela cache, e pode ser feita com SIMD.
+// Os campos específicos de cada tabela (back-pointer da entrada, cadeia da HAT) ficam em
+// vetores próprios dos simuladores
+#define FRAMES_ALIGNMENT 64
+
+// Kernels das varreduras. As versões SSE4.1 e AVX2 são escolhidas em tempo de execução pelo
+// processador, com a escalar como reserva; todas dão exatamente o mesmo resultado. min_index só
+// é medido pelo bench_frames: o LRU dos simuladores usa a lista de recência (lru.h), e os quadros
+// livres são entregues em ordem, sem varredura
+typedef struct {
+    const char *name;
+    // Primeiro índice de [from, to) com bytes[i] == value, ou -1
+    int (*find_byte)(const uint8_t *bytes, unsigned from, unsigned to, uint8_t value);
+    // Índice do menor valor (o primeiro, em caso de empate), ou -1 se count == 0
+    int (*min_index)(const uint32_t *values, unsigned count);
+} FrameKernels;
+
+typedef struct {
+    unsigned count;
+    uint64_t *page_number;
+    uint8_t *valid;
+    uint8_t *modified;
+    uint8_t *referenced;
+    const FrameKernels *kernels;
+} FrameTable;
+
+// Aloca os vetores zerados (todos os quadros inválidos) e escolhe os kernels do processador
+void frames_init(FrameTable *frames, unsigned count);
+
+void frames_free(FrameTable *frames);
+
+// Vetor zerado alinhado à linha de cache, para os campos próprios de cada simulador
+void *frames_alloc_array(unsigned count, size_t element_size);
+
+// Melhor conjunto de kernels suportado pelo processador
+const FrameKernels *frames_best_kernels();
+
+// Conjuntos suportados pelo processador, do escalar ao mais largo (para o microbenchmark).
+// Retorna quantos foram escritos em list
+int frames_supported_kernels(const FrameKernels **list, int max);
+
+// Passos do relógio dados quadro a quadro antes de passar para a varredura vetorial: na maioria
+// das faltas a vítima está a poucos quadros do ponteiro
+#define FRAMES_CLOCK_SCALAR_STEPS 8
+
+// Continuação vetorial de frames_clock_victim
+int frames_clock_sweep(FrameTable *frames, unsigned *hand);
+
+// Vítima da segunda chance: a partir do ponteiro, o primeiro quadro com o bit de referenciada
+// desligado. Os quadros pulados perdem o bit, como no laço do relógio, e o ponteiro fica logo
+// depois da vítima
+static inline int frames_clock_victim(FrameTable *frames, unsigned *hand) {
+    unsigned victim = *hand;
+    for (int step = 0; step < FRAMES_CLOCK_SCALAR_STEPS; step++) {
+        unsigned next = victim + 1 == frames->count ? 0 : victim + 1;
+        if (!frames->referenced[victim]) {
+            *hand = next;
+            return (int)victim;
+        }
+        frames->referenced[victim] = 0;
+        PROF_COUNT(PROF_SKIPPED_FRAMES, 1);
+        victim = next;
+    }
+    *hand = victim;
+    return frames_clock_sweep(frames, hand);
+}
+
+#endif
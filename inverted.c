@@ -3,82 +3,261 @@
 #include <string.h>
 #include <stdint.h>
 
-// Estrutura para representar um quadro na tabela invertida
-typedef struct {
-    unsigned virtual_page;
-    int dirty;
-    int referenced;
-    unsigned last_access;
-    int valid;
-} Frame;
+#include "frames.h"
+#include "lru.h"
+#include "opt.h"
+#include "prof.h"
+#include "repl.h"
+#include "series.h"
+#include "shards.h"
+#include "trace.h"
+#include "writeback.h"
+#include "sim.h"
 
 // Variáveis globais
-Frame *inverted_table = NULL;
-unsigned num_frames = 0;
-unsigned page_size = 0;
-unsigned mem_size = 0;
-char replacement_algo[10];
-long unsigned access_count = 0;
-unsigned page_faults = 0;
-unsigned dirty_pages_written = 0;
+// A tabela invertida é a tabela de quadros em estrutura de vetores (frames.h): page_number guarda
+// a página virtual de cada quadro ((uint64_t)-1 enquanto livre) e modified o bit de suja.
+// next_in_chain é o próximo quadro na cadeia de colisão da HAT (-1 no fim)
+static _Thread_local FrameTable inverted_table;
+static _Thread_local int *next_in_chain = NULL;
+static _Thread_local unsigned num_frames = 0;
+static _Thread_local unsigned page_size = 0;
+static _Thread_local unsigned mem_size = 0;
+static _Thread_local char replacement_algo[10];
+static _Thread_local long unsigned access_count = 0;
+static _Thread_local unsigned page_faults = 0;
+static _Thread_local unsigned dirty_pages_written = 0;
+static _Thread_local LruList lru_list;
+static _Thread_local SimRandom rng;
+static _Thread_local int policy_id;
+static _Thread_local Tlb tlb;
+static _Thread_local Repl repl;
+static _Thread_local Opt opt;
+static _Thread_local Writeback writeback;
+static _Thread_local Shards shards;
+static _Thread_local Series series;
+
+// Tabela de âncoras (HAT): cada posição aponta para o primeiro quadro da cadeia
+// das páginas virtuais com aquele hash. As cadeias passam pelo próprio vetor de quadros
+static _Thread_local int *hash_anchor_table = NULL;
+static _Thread_local unsigned hat_bits = 0;
+static _Thread_local unsigned hat_size = 0;
+static _Thread_local double load_factor = 1.0;
+static _Thread_local unsigned next_free_frame = 0;
+static _Thread_local unsigned fifo_next_frame = 0;
+static _Thread_local unsigned clock_pointer = 0;
+static _Thread_local long unsigned total_lookups = 0;
+static _Thread_local long unsigned total_probes = 0;
 
 // Funções auxiliares
-void init_simulation();
-void process_memory_access(FILE *file);
-int find_page(unsigned virtual_page);
-int choose_frame_to_replace();
-void print_report();
-
+static void init_simulation();
+static void release_simulation();
+SIM_INLINE void process_memory_access(TraceReader *file, const int policy);
+static inline int find_page(uint64_t virtual_page);
+static inline void hat_insert(int frame);
+static inline void count_repeated_lookups(int frame, unsigned long repeats);
+static inline void hat_remove(int frame);
+SIM_INLINE int choose_frame_to_replace(uint64_t virtual_page, const int policy);
+SIM_INLINE void mark_modified(int frame, int written);
+static void run_writeback() SIM_COLD;
+static SeriesSample window_sample();
+static void record_window() SIM_COLD;
+static void print_report(const char *input_file) SIM_UNUSED;
+
+SIM_DEFINE_KERNELS(process_memory_access);
+
+#ifndef SIM_LIBRARY
 // Função principal
 int main(int argc, char *argv[]) {
-    if (argc != 5) {
-        fprintf(stderr, "Uso: %s <algoritmo> <arquivo.log> <tamanho_pagina> <memoria_fisica>\n", argv[0]);
+    if (argc < 5 || argc > 11) {
+        fprintf(stderr, "Uso: %s <algoritmo> <arquivo.log> <tamanho_pagina> <memoria_fisica> [fator_carga] [tlb=entradas/vias/politica] [wb=periodo/lote/fundo/limite] [shards=taxa/paginas] [prof=json|csv[:arquivo]] [series=janela[/csv|/bin][:arquivo]]\n", argv[0]);
         return 1;
     }
 
-    strncpy(replacement_algo, argv[1], sizeof(replacement_algo) - 1);
-    page_size = atoi(argv[3]) * 1024;
-    mem_size = atoi(argv[4]) * 1024;
-    num_frames = mem_size / page_size;
+    SimConfig config = {argv[1], atoi(argv[3]), atoi(argv[4]), SIM_DEFAULT_SEED, 0};
 
-    inverted_table = (Frame *)calloc(num_frames, sizeof(Frame));
-    if (!inverted_table) {
-        fprintf(stderr, "Erro ao alocar memória para a tabela invertida.\n");
-        return 1;
+    for (int i = 5; i < argc; i++) {
+        int option = sim_parse_tlb_option(argv[i], &config);
+        if (option == 0) {
+            option = sim_parse_writeback_option(argv[i], &config);
+        }
+        if (option == 0) {
+            option = sim_parse_shards_option(argv[i], &config);
+        }
+        if (option == 0) {
+            option = sim_parse_profile_option(argv[i], &config);
+        }
+        if (option == 0) {
+            option = sim_parse_series_option(argv[i], &config);
+        }
+        if (option < 0) {
+            return 1;
+        }
+        if (option == 0) {
+            config.load_factor = atof(argv[i]);
+            if (config.load_factor <= 0.0) {
+                fprintf(stderr, "Fator de carga inválido: %s\n", argv[i]);
+                return 1;
+            }
+        }
     }
 
-    FILE *file = fopen(argv[2], "r");
-    if (!file) {
+    TraceReader file;
+    if (trace_open(&file, argv[2]) != 0) {
         fprintf(stderr, "Erro ao abrir o arquivo %s.\n", argv[2]);
-        free(inverted_table);
         return 1;
     }
 
-    init_simulation();
-    process_memory_access(file);
+    SimResult result;
+    if (inverted_simulate(&config, &file, &result) != 0) {
+        trace_close(&file);
+        return 1;
+    }
 
-    fclose(file);
     print_report(argv[2]);
-    free(inverted_table);
+    trace_print_stats(&file);
+    if (config.profile_format != PROF_FORMAT_NONE &&
+        prof_write(&sim_profile, config.profile_format, config.profile_path, "inverted", argv[1], argv[2], result.accesses) != 0) {
+        trace_close(&file);
+        return 1;
+    }
+    trace_close(&file);
 
     return 0;
 }
+#endif
+
+// Executa a simulação completa do trace (chamada pelo main e pelo sweep)
+int inverted_simulate(const SimConfig *config, TraceReader *trace, SimResult *result) {
+
+    policy_id = sim_policy_id(config->policy);
+    if (policy_id < 0) {
+        fprintf(stderr, "Algoritmo de substituição desconhecido: %s\n", config->policy);
+        return -1;
+    }
+
+    strncpy(replacement_algo, config->policy, sizeof(replacement_algo) - 1);
+    page_size = config->page_size_kb * 1024;
+    mem_size = config->memory_kb * 1024;
+    unsigned page_shift = 0;
+    while ((1u << page_shift) < page_size) {
+        page_shift++;
+    }
+    if (shards_init(&shards, config->sample_rate, config->sample_budget, trace, page_shift) != 0) {
+        return -1;
+    }
+    num_frames = shards_frames(&shards, mem_size / page_size);
+    load_factor = config->load_factor > 0 ? config->load_factor : 1.0;
+    sim_random_seed(&rng, config->seed);
+    tlb_init(&tlb, config->tlb_entries, config->tlb_ways, config->tlb_policy);
+
+    frames_init(&inverted_table, num_frames);
+    next_in_chain = (int *)frames_alloc_array(num_frames, sizeof(int));
+
+    init_simulation();
+    writeback_init(&writeback, config->wb_period, config->wb_batch,
+                   config->wb_background_ratio, config->wb_dirty_ratio, num_frames);
+    if (policy_id == POLICY_OPT && opt_init(&opt, trace, page_shift, num_frames) != 0) {
+        release_simulation();
+        return -1;
+    }
+    if (series_start(&series, config->series_window, config->series_format, config->series_path,
+                     shards.enabled ? shards.rate : 0) != 0) {
+        release_simulation();
+        return -1;
+    }
+
+    PROF_RUN_BEGIN();
+    kernels[policy_id](trace);
+    PROF_RUN_END();
+    SeriesSample last = window_sample();
+    if (series_finish(&series, &last) != 0 || trace->failed) {
+        release_simulation();
+        return -1;
+    }
+
+    result->page_faults = page_faults;
+    result->pages_written = dirty_pages_written;
+    result->accesses = access_count;
+    result->tlb_hits = tlb.hits;
+    result->ghost_hits = sim_policy_uses_repl(policy_id) ? repl.ghost_hits : 0;
+    // A tabela invertida é a HAT mais a página e o elo da cadeia de cada quadro
+    result->page_table_bytes = (size_t)hat_size * sizeof(int) + (size_t)num_frames * (sizeof(uint64_t) + sizeof(int));
+    sim_writeback_result(&writeback, result);
+    sim_shards_result(&shards, result);
+
+    release_simulation();
+    return 0;
+}
 
 // Inicializar a memória física e tabela de páginas
-void init_simulation() {
+static void init_simulation() {
+
+    access_count = 0;
+    page_faults = 0;
+    dirty_pages_written = 0;
+    next_free_frame = 0;
+    fifo_next_frame = 0;
+    clock_pointer = 0;
+    total_lookups = 0;
+    total_probes = 0;
+
     for (unsigned i = 0; i < num_frames; i++) {
-        inverted_table[i].virtual_page = -1;
-        inverted_table[i].dirty = 0;
-        inverted_table[i].referenced = 0;
-        inverted_table[i].last_access = 0;
-        inverted_table[i].valid = 0;
+        inverted_table.page_number[i] = -1;
+        next_in_chain[i] = -1;
+    }
+
+    // A HAT tem a menor potência de 2 que comporta num_frames / fator de carga
+    hat_bits = 0;
+    while ((1u << hat_bits) < num_frames / load_factor && hat_bits < 31) {
+        hat_bits++;
+    }
+    hat_size = 1u << hat_bits;
+
+    hash_anchor_table = (int *)malloc(hat_size * sizeof(int));
+    if (!hash_anchor_table) {
+        fprintf(stderr, "Erro ao alocar memória para a tabela de âncoras.\n");
+        exit(1);
     }
+    for (unsigned i = 0; i < hat_size; i++) {
+        hash_anchor_table[i] = -1;
+    }
+
+    if (policy_id == POLICY_LRU) {
+        lru_init(&lru_list, num_frames);
+    }
+    if (sim_policy_uses_repl(policy_id)) {
+        repl_init(&repl, policy_id - POLICY_ARC, num_frames);
+    }
+}
+
+// Libera a tabela invertida e a HAT; os totais continuam disponíveis para o relatório
+static void release_simulation() {
+    frames_free(&inverted_table);
+    free(next_in_chain);
+    free(hash_anchor_table);
+    next_in_chain = NULL;
+    hash_anchor_table = NULL;
+    if (policy_id == POLICY_LRU) {
+        lru_free(&lru_list);
+    }
+    if (sim_policy_uses_repl(policy_id)) {
+        repl_free(&repl);
+    }
+    if (policy_id == POLICY_OPT) {
+        opt_free(&opt);
+    }
+    tlb_free(&tlb);
 }
 
-//Simula a execução de um acesso à memória com uma dada função (leitura ou escrita)
-void process_memory_access(FILE *file) {
-    unsigned addr;
+//Simula a execução de um acesso à memória com uma dada função (leitura ou escrita),
+// instanciado uma vez por política por SIM_DEFINE_KERNELS. Os acessos seguidos à mesma página
+// depois do primeiro são acertos e são aplicados de uma vez
+SIM_INLINE void process_memory_access(TraceReader *file, const int policy) {
+    uint64_t addr;
     char rw;
+    unsigned long repeats;
+    int repeats_written;
     unsigned s = 0, tmp = page_size;
 
     while (tmp > 1) {
@@ -86,96 +265,219 @@ void process_memory_access(FILE *file) {
         s++;
     }
 
-    while (fscanf(file, "%x %c", &addr, &rw) == 2) {
+    while (PROF_TIME(PROF_PARSE, trace_next_run(file, s, &addr, &rw, writeback_run_limit(&writeback, access_count),
+                                                &repeats, &repeats_written))) {
+        if (shards_skip(&shards, addr >> s, repeats)) {
+            continue;
+        }
         access_count++;
-        unsigned virtual_page = addr >> s;
+        uint64_t virtual_page = addr >> s;
+
+        // Acerto na TLB: usa o quadro guardado sem percorrer a cadeia da HAT
+        PROF_START(lookup);
+        TlbEntry *cached = tlb_enabled(&tlb) ? tlb_lookup(&tlb, virtual_page) : NULL;
+        int frame = cached ? cached->frame : find_page(virtual_page);
+        PROF_STOP(PROF_LOOKUP, lookup);
 
-        int frame = find_page(virtual_page);
         if (frame == -1) {
 
+            PROF_START(fault);
             page_faults++;
-            frame = choose_frame_to_replace();
+            frame = PROF_TIME(PROF_EVICT, choose_frame_to_replace(virtual_page, policy));
 
-            if (inverted_table[frame].dirty) {
+            if (inverted_table.modified[frame]) {
                 dirty_pages_written++;
             }
 
-            inverted_table[frame].virtual_page = virtual_page;
-            inverted_table[frame].dirty = 0;
+            if (inverted_table.page_number[frame] != (uint64_t)-1) {
+                PROF_COUNT(PROF_VICTIM_SEARCHES, 1);
+                writeback_evicted(&writeback, inverted_table.modified[frame]);
+                if (tlb_enabled(&tlb)) {
+                    tlb_invalidate(&tlb, inverted_table.page_number[frame]);
+                }
+                hat_remove(frame);
+            }
+
+            inverted_table.page_number[frame] = virtual_page;
+            inverted_table.valid[frame] = 1;
+            inverted_table.modified[frame] = 0;
+            hat_insert(frame);
+            PROF_STOP(PROF_FAULT, fault);
         } else {
 
-        inverted_table[frame].referenced = 1;
-        inverted_table[frame].last_access = access_count;
-        
+        inverted_table.referenced[frame] = 1;
+        if (policy == POLICY_LRU) {
+            lru_touch(&lru_list, frame);
+        } else if (sim_policy_uses_repl(policy)) {
+            repl_hit(&repl, frame);
+        }
+
+        }
+
+        if (!cached && tlb_enabled(&tlb)) {
+            cached = tlb_insert(&tlb, virtual_page, frame, 0);
+        }
+
+        mark_modified(frame, rw == 'W');
+
+        if (repeats) {
+            access_count += repeats;
+            inverted_table.referenced[frame] = 1;
+                mark_modified(frame, repeats_written);
+            if (policy == POLICY_LRU) {
+                lru_touch(&lru_list, frame);
+            } else if (sim_policy_uses_repl(policy)) {
+                repl_hits(&repl, frame, repeats);
+            }
+
+            if (cached) {
+                tlb_repeat_hits(&tlb, cached, repeats);
+            } else {
+                count_repeated_lookups(frame, repeats);
+            }
         }
 
-        if (rw == 'W') {
-            inverted_table[frame].dirty = 1;
+        // O próximo uso da página é o do último acesso da sequência
+        if (policy == POLICY_OPT) {
+            opt_touch(&opt, frame, file->position - 1);
+        }
+        if (writeback_due(&writeback, access_count)) {
+            run_writeback();
+        }
+        if (series_due(&series, access_count + shards.skipped_accesses)) {
+            record_window();
         }
     }
 }
 
-int find_page(unsigned virtual_page) {
-    for (unsigned i = 0; i < num_frames; i++) {
-        if (inverted_table[i].virtual_page == virtual_page) {
-            return i;
+// Liga o bit de suja do quadro, contando a página que passa a estar suja
+SIM_INLINE void mark_modified(int frame, int written) {
+    uint8_t was_modified = inverted_table.modified[frame];
+    inverted_table.modified[frame] = was_modified | (written != 0);
+    writeback_dirtied(&writeback, (written != 0) & !was_modified);
+}
+
+// Rodada do limpador: escreve as páginas sujas dos quadros a partir do ponteiro dele. O bit de
+// suja fica na tabela invertida, não na TLB, então as traduções continuam valendo
+static void run_writeback() {
+    PROF_START(start);
+    unsigned pending = writeback_begin(&writeback, access_count);
+    for (unsigned step = 0; pending > 0 && step < num_frames; step++) {
+        unsigned frame = writeback.hand;
+        writeback.hand = frame + 1 == num_frames ? 0 : frame + 1;
+
+        if (inverted_table.modified[frame]) {
+            inverted_table.modified[frame] = 0;
+            dirty_pages_written++;
+            writeback_cleaned(&writeback);
+            pending--;
         }
     }
-    return -1;
+    PROF_STOP(PROF_WRITEBACK, start);
 }
 
-int choose_frame_to_replace() {
+// Contadores acumulados da série por janelas, no tempo do trace (com os acessos fora da amostra)
+static SeriesSample window_sample() {
+    SeriesSample sample = {access_count + shards.skipped_accesses, access_count, page_faults, dirty_pages_written, writeback.dirty};
+    return sample;
+}
 
-    for (unsigned i = 0; i < num_frames; i++) {
-        if (inverted_table[i].virtual_page == -1) {
-            return i;
+// Fim de uma janela da série
+static void record_window() {
+    SeriesSample sample = window_sample();
+    series_record(&series, &sample);
+}
+
+// Hash multiplicativo (Fibonacci) do número da página virtual. A metade alta das páginas de 64
+// bits é dobrada sobre a baixa antes, o que deixa o hash das páginas de 32 bits como era
+static inline unsigned hat_hash(uint64_t virtual_page) {
+    uint32_t folded = (uint32_t)(virtual_page ^ (virtual_page >> 32));
+    return hat_bits == 0 ? 0 : (unsigned)((folded * 2654435761u) >> (32 - hat_bits));
+}
+
+// Percorre apenas a cadeia do hash da página, contando as sondagens
+static inline int find_page(uint64_t virtual_page) {
+    total_lookups++;
+    PROF_COUNT(PROF_WALKS, 1);
+    PROF_COUNT(PROF_WALK_LEVELS, 1);
+    int frame = hash_anchor_table[hat_hash(virtual_page)];
+    while (frame != -1) {
+        total_probes++;
+        PROF_COUNT(PROF_WALK_LEVELS, 1);
+        if (inverted_table.page_number[frame] == virtual_page) {
+            return frame;
         }
+        frame = next_in_chain[frame];
     }
+    return -1;
+}
 
-    // Implementação dos algoritmos de substituição de página
-    if (strcmp(replacement_algo, "lru") == 0) {
-        unsigned lru_frame = 0;
-        unsigned oldest_time = inverted_table[0].last_access;
-        for (unsigned i = 1; i < num_frames; i++) {
-            if (inverted_table[i].last_access < oldest_time) {
-                oldest_time = inverted_table[i].last_access;
-                lru_frame = i;
-            }
-        }
-        return lru_frame;
+// Conta as buscas que os acessos repetidos à página do quadro teriam feito, com as mesmas
+// sondagens da posição dele na cadeia
+static inline void count_repeated_lookups(int frame, unsigned long repeats) {
+    unsigned long probes = 1;
+    for (int f = hash_anchor_table[hat_hash(inverted_table.page_number[frame])]; f != frame; f = next_in_chain[f]) {
+        probes++;
+    }
+    total_lookups += repeats;
+    total_probes += probes * repeats;
+}
 
-    } else if (strcmp(replacement_algo, "fifo") == 0) {
+// Insere o quadro no início da cadeia da sua página virtual
+static inline void hat_insert(int frame) {
+    unsigned h = hat_hash(inverted_table.page_number[frame]);
+    next_in_chain[frame] = hash_anchor_table[h];
+    hash_anchor_table[h] = frame;
+}
 
-        static int next_frame = 0;
-        int victim = next_frame;
-        next_frame = (next_frame + 1) % num_frames;
-        return victim;
+// Retira o quadro da cadeia da página que ele contém
+static inline void hat_remove(int frame) {
+    int *link = &hash_anchor_table[hat_hash(inverted_table.page_number[frame])];
+    while (*link != frame) {
+        link = &next_in_chain[*link];
+    }
+    *link = next_in_chain[frame];
+    next_in_chain[frame] = -1;
+}
+
+SIM_INLINE int choose_frame_to_replace(uint64_t virtual_page, const int policy) {
 
-    } else if (strcmp(replacement_algo, "random") == 0) {
+    // As políticas de repl.c e a opt escolhem também entre os quadros livres, que entregam na mesma ordem
+    if (sim_policy_uses_repl(policy)) {
+        return repl_miss(&repl, virtual_page);
+    }
+    if (policy == POLICY_OPT) {
+        return opt_victim(&opt);
+    }
 
-        return random() % num_frames;
+    // Quadros nunca são liberados, então os livres são sempre os de índice >= next_free_frame
+    if (next_free_frame < num_frames) {
+        return next_free_frame++;
+    }
 
-    } else if (strcmp(replacement_algo, "2a") == 0) { 
+    // Implementação dos algoritmos de substituição de página
+    switch (policy) {
+    case POLICY_LRU:
+        // A cauda da lista de recência é a vítima. Só os acertos levam o quadro para a cabeça: a
+        // carga numa falta não o move, então ele fica na cauda até o primeiro acerto
+        return lru_victim(&lru_list);
+
+    case POLICY_FIFO: {
+        int victim = fifo_next_frame;
+        fifo_next_frame = (fifo_next_frame + 1) % num_frames;
+        return victim;
+    }
 
-        static int pointer = 0;
-        while (1) {
-            int victim = pointer;
-            pointer = (pointer + 1) % num_frames;
+    case POLICY_RANDOM:
+        return sim_random_next(&rng) % num_frames;
 
-            if (inverted_table[victim].referenced == 0) {
-                return victim; 
-            } else {
-                inverted_table[victim].referenced = 0;
-            }
-        }
-    } else {
-        fprintf(stderr, "Algoritmo de substituição desconhecido: %s\n", replacement_algo);
-        exit(1);
+    case POLICY_2A:
+        return frames_clock_victim(&inverted_table, &clock_pointer);
     }
     return 0;
 }
 
-void print_report(const char *input_file) {
+static void print_report(const char *input_file) {
 
     // printf("Memória gasta = %.2f KB\n", (double)(num_frames) / 128.0);
     printf("Executando o simulador...\n");
@@ -183,7 +485,18 @@ void print_report(const char *input_file) {
     printf("Tamanho da memoria: %u KB\n", mem_size / 1024);
     printf("Tamanho das paginas: %u KB\n", page_size / 1024);
     printf("Tecnica de reposicao: %s\n", replacement_algo);
-    printf("Paginas lidas: %u\n", page_faults);
-    printf("Paginas escritas: %u\n", dirty_pages_written);
-    printf("Total de acessos à memória: %lu\n", access_count);
+    printf("Paginas lidas: %lu\n", shards_estimate(&shards, page_faults));
+    printf("Paginas escritas: %lu\n", shards_estimate(&shards, dirty_pages_written));
+    printf("Total de acessos à memória: %lu\n", access_count + shards.skipped_accesses);
+    shards_print_stats(&shards, access_count);
+    writeback_print_stats(&writeback);
+    printf("Tamanho da HAT: %u entradas (fator de carga %.2f)\n", hat_size, (double)num_frames / hat_size);
+    printf("Comprimento medio de sondagem: %.3f\n", total_lookups ? (double)total_probes / total_lookups : 0.0);
+    tlb_print_stats(&tlb);
+    if (sim_policy_uses_repl(policy_id)) {
+        repl_print_stats(&repl);
+    }
+    if (policy_id == POLICY_OPT) {
+        opt_print_stats(&opt);
+    }
 }
@@ -0,0 +1,33 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lru.h"
+
+// Monta a lista com o quadro num_frames-1 na cabeça e o quadro 0 na cauda
+void lru_init(LruList *list, unsigned num_frames) {
+
+    list->prev = (int *)malloc(num_frames * sizeof(int));
+    list->next = (int *)malloc(num_frames * sizeof(int));
+
+    if (!list->prev || !list->next) {
+        fprintf(stderr, "Erro ao alocar memória para a lista LRU\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (unsigned i = 0; i < num_frames; i++) {
+        list->next[i] = (int)i - 1;
+        list->prev[i] = (i + 1 < num_frames) ? (int)i + 1 : -1;
+    }
+
+    list->head = (int)num_frames - 1;
+    list->tail = num_frames > 0 ? 0 : -1;
+}
+
+void lru_free(LruList *list) {
+    free(list->prev);
+    free(list->next);
+    list->prev = NULL;
+    list->next = NULL;
+    list->head = -1;
+    list->tail = -1;
+}
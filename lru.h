@@ -0,0 +1,49 @@
+#ifndef LRU_H
+#define LRU_H
+
+// Lista de recência dos quadros (LRU em O(1)), compartilhada por todas as tabelas
+// Os quadros são mantidos numa lista duplamente encadeada por índices:
+// a cabeça é o quadro usado mais recentemente e a cauda é a vítima do LRU
+typedef struct {
+    int *prev;
+    int *next;
+    int head;
+    int tail;
+} LruList;
+
+// Inicializa a lista com os quadros 0..num_frames-1, com o quadro 0 na cauda.
+// Isso reproduz o desempate por menor índice da busca linear pelo menor timestamp
+void lru_init(LruList *list, unsigned num_frames);
+
+void lru_free(LruList *list);
+
+// Move o quadro para a cabeça da lista (acesso mais recente)
+static inline void lru_touch(LruList *list, int frame) {
+    if (list->head == frame) {
+        return;
+    }
+
+    int p = list->prev[frame];
+    int n = list->next[frame];
+
+    // Retira o quadro da posição atual (ele não é a cabeça, então p != -1)
+    list->next[p] = n;
+    if (n != -1) {
+        list->prev[n] = p;
+    } else {
+        list->tail = p;
+    }
+
+    // Insere na cabeça
+    list->prev[frame] = -1;
+    list->next[frame] = list->head;
+    list->prev[list->head] = frame;
+    list->head = frame;
+}
+
+// Quadro menos recentemente usado
+static inline int lru_victim(const LruList *list) {
+    return list->tail;
+}
+
+#endif
@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#include "opt.h"
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int opt_init(Opt *opt, TraceReader *trace, unsigned page_shift, unsigned frames) {
+
+    memset(opt, 0, sizeof(*opt));
+
+    if (trace_make_resident(trace) != 0) {
+        return -1;
+    }
+
+    // A simulação ainda não começou, então o trace inteiro está em records a partir da posição 0
+    size_t count = trace->batch_count;
+    if (count >= OPT_NEVER) {
+        fprintf(stderr, "Erro: trace grande demais para a política opt (%zu acessos)\n", count);
+        return -1;
+    }
+
+    opt->count = count;
+    opt->capacity = frames;
+    opt->next_use = (uint32_t *)malloc((count ? count : 1) * sizeof(uint32_t));
+    opt->key = (uint32_t *)calloc(frames, sizeof(uint32_t));
+    opt->heap = (int *)malloc(frames * sizeof(int));
+    opt->slot = (int *)malloc(frames * sizeof(int));
+
+    // Num trace de 64 bits as páginas são numeradas antes (trace_number_pages), em next_use: a
+    // passada abaixo lê o número de cada posição antes de escrever o próximo uso nela
+    int numbered = trace->address_bits == 64;
+    size_t num_pages = (size_t)1 << (32 - page_shift);
+    if (numbered && opt->next_use) {
+        long distinct = trace_number_pages(trace->records64, count, page_shift, opt->next_use);
+        num_pages = distinct > 0 ? (size_t)distinct : 1;
+        if (distinct < 0) {
+            opt_free(opt);
+            return -1;
+        }
+    }
+
+    // Última posição vista de cada página, mais um (0 = ainda não vista). Como a tabela do dense,
+    // é um mapeamento anônimo que só ocupa memória nas páginas que o trace toca, e só vive
+    // durante a passada
+    size_t pages_bytes = num_pages * sizeof(uint32_t);
+    uint32_t *seen = (uint32_t *)mmap(NULL, pages_bytes, PROT_READ | PROT_WRITE,
+                                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+    if (!opt->next_use || !opt->key || !opt->heap || !opt->slot || seen == MAP_FAILED) {
+        fprintf(stderr, "Erro ao alocar memória para a política opt\n");
+        if (seen != MAP_FAILED) {
+            munmap(seen, pages_bytes);
+        }
+        opt_free(opt);
+        return -1;
+    }
+    for (unsigned i = 0; i < frames; i++) {
+        opt->slot[i] = -1;
+    }
+
+    double start = now_seconds();
+    for (size_t i = count; i-- > 0;) {
+        uint32_t page = numbered ? opt->next_use[i] : trace->records[i] >> page_shift;
+        opt->next_use[i] = seen[page] ? seen[page] - 1 : OPT_NEVER;
+        seen[page] = (uint32_t)i + 1;
+    }
+    opt->index_seconds = now_seconds() - start;
+
+    munmap(seen, pages_bytes);
+    return 0;
+}
+
+void opt_free(Opt *opt) {
+    free(opt->next_use);
+    free(opt->key);
+    free(opt->heap);
+    free(opt->slot);
+    opt->next_use = NULL;
+    opt->key = NULL;
+    opt->heap = NULL;
+    opt->slot = NULL;
+}
+
+void opt_sift_up(Opt *opt, unsigned index) {
+    int frame = opt->heap[index];
+    uint32_t key = opt->key[frame];
+    while (index > 0) {
+        unsigned parent = (index - 1) / 2;
+        int parent_frame = opt->heap[parent];
+        if (opt->key[parent_frame] >= key) {
+            break;
+        }
+        opt->heap[index] = parent_frame;
+        opt->slot[parent_frame] = (int)index;
+        index = parent;
+    }
+    opt->heap[index] = frame;
+    opt->slot[frame] = (int)index;
+}
+
+void opt_sift_down(Opt *opt, unsigned index) {
+    int frame = opt->heap[index];
+    uint32_t key = opt->key[frame];
+    for (;;) {
+        unsigned child = 2 * index + 1;
+        if (child >= opt->size) {
+            break;
+        }
+        if (child + 1 < opt->size && opt->key[opt->heap[child + 1]] > opt->key[opt->heap[child]]) {
+            child++;
+        }
+        int child_frame = opt->heap[child];
+        if (opt->key[child_frame] <= key) {
+            break;
+        }
+        opt->heap[index] = child_frame;
+        opt->slot[child_frame] = (int)index;
+        index = child;
+    }
+    opt->heap[index] = frame;
+    opt->slot[frame] = (int)index;
+}
+
+void opt_print_stats(const Opt *opt) {
+    printf("Indice de proximo uso: %zu acessos (%.1f MB) montado em %.3f s\n",
+           opt->count, opt->count * sizeof(uint32_t) / 1e6, opt->index_seconds);
+}
@@ -0,0 +1,69 @@
+#ifndef OPT_H
+#define OPT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "trace.h"
+
+// Política ótima de Belady (MIN), compartilhada pelas quatro tabelas: despeja a página residente
+// cujo próximo uso é o mais distante. Antes da simulação uma passada de trás para frente sobre o
+// trace inteiro monta next_use (4 bytes por registro): para cada registro, a posição do próximo
+// acesso à mesma página. Os quadros ficam num max-heap indexado pelo próximo uso da sua página,
+// então a vítima está na raiz e cada acesso ou carga custa O(log quadros)
+
+// Próximo uso de uma página que não volta a ser acessada
+#define OPT_NEVER UINT32_MAX
+
+typedef struct {
+    uint32_t *next_use;     // por registro do trace
+    size_t count;
+    double index_seconds;   // tempo da passada que montou next_use
+
+    unsigned capacity;      // quadros
+    unsigned next_free;     // quadros ainda não usados, entregues em ordem
+    uint32_t *key;          // próximo uso da página de cada quadro
+    int *heap;              // quadros, com o maior key na raiz
+    int *slot;              // posição de cada quadro em heap, -1 se ainda não entrou
+    unsigned size;
+} Opt;
+
+// Monta o índice de próximo uso para páginas de 2^page_shift bytes. O trace inteiro fica residente
+// (trace_make_resident) e as posições passadas a opt_touch são índices em trace->records.
+// Retorna 0 em caso de sucesso e -1 se o trace não couber (mais de 2^32 - 1 registros) ou faltar memória
+int opt_init(Opt *opt, TraceReader *trace, unsigned page_shift, unsigned frames);
+
+void opt_free(Opt *opt);
+
+// Continuações do heap para opt_touch
+void opt_sift_up(Opt *opt, unsigned index);
+void opt_sift_down(Opt *opt, unsigned index);
+
+// Quadro para a página que faltou: um livre ou o da página de próximo uso mais distante
+static inline int opt_victim(Opt *opt) {
+    return opt->next_free < opt->capacity ? (int)opt->next_free++ : opt->heap[0];
+}
+
+// Acesso (ou carga) ao quadro cujo último acesso seguido à mesma página está na posição position.
+// Num acerto o próximo uso só anda para frente e o quadro sobe no heap; numa carga ele toma o
+// lugar da vítima, na raiz, e desce
+static inline void opt_touch(Opt *opt, int frame, size_t position) {
+    uint32_t old_key = opt->key[frame];
+    uint32_t new_key = opt->next_use[position];
+    opt->key[frame] = new_key;
+
+    if (opt->slot[frame] < 0) {
+        opt->heap[opt->size] = frame;
+        opt->slot[frame] = (int)opt->size;
+        opt_sift_up(opt, opt->size++);
+    } else if (new_key > old_key) {
+        opt_sift_up(opt, (unsigned)opt->slot[frame]);
+    } else if (new_key < old_key) {
+        opt_sift_down(opt, (unsigned)opt->slot[frame]);
+    }
+}
+
+// Tamanho e tempo de montagem do índice de próximo uso
+void opt_print_stats(const Opt *opt);
+
+#endif
@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "prof.h"
+
+_Thread_local Profile sim_profile;
+
+int prof_parse_spec(const char *spec, int *format, const char **path) {
+
+#ifndef SIM_PROFILE
+    (void)format;
+    (void)path;
+    fprintf(stderr, "Perfil indisponível: %s (a instrumentação só existe com make clean && make PROFILE=1)\n", spec);
+    return -1;
+#else
+    const char *colon = strchr(spec, ':');
+    size_t length = colon ? (size_t)(colon - spec) : strlen(spec);
+
+    if (length == 4 && strncmp(spec, "json", 4) == 0) {
+        *format = PROF_FORMAT_JSON;
+    } else if (length == 3 && strncmp(spec, "csv", 3) == 0) {
+        *format = PROF_FORMAT_CSV;
+    } else {
+        fprintf(stderr, "Perfil inválido: %s (use json ou csv, com :arquivo opcional)\n", spec);
+        return -1;
+    }
+    if (colon && colon[1] == '\0') {
+        fprintf(stderr, "Perfil inválido: %s (arquivo vazio)\n", spec);
+        return -1;
+    }
+    *path = colon ? colon + 1 : NULL;
+    return 0;
+#endif
+}
+
+void prof_reset(Profile *profile) {
+
+    memset(profile, 0, sizeof(*profile));
+
+#ifdef SIM_PROFILE
+    // O menor intervalo entre duas leituras seguidas
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < 1000; i++) {
+        uint64_t start = prof_cycles();
+        uint64_t elapsed = prof_cycles() - start;
+        if (elapsed < best) {
+            best = elapsed;
+        }
+    }
+    profile->read_cost = best;
+#endif
+}
+
+#ifdef SIM_PROFILE
+static const char *phase_names[PROF_PHASES] = {"leitura", "busca", "falta", "vitima", "limpador"};
+
+static const char *counter_names[PROF_COUNTERS] = {
+    "percursos", "niveis_lidos", "escolhas_vitima", "quadros_pulados",
+    "tabelas_alocadas", "tabelas_liberadas", "pedacos_slab"
+};
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// O relógio monotônico marca o mesmo intervalo que o contador, para converter ciclos em segundos
+static _Thread_local uint64_t run_start;
+static _Thread_local double run_start_seconds;
+
+void prof_run_begin(Profile *profile) {
+    (void)profile;
+    run_start_seconds = now_seconds();
+    run_start = prof_cycles();
+}
+
+void prof_run_end(Profile *profile) {
+    profile->run_cycles = prof_cycles() - run_start;
+    profile->run_seconds = now_seconds() - run_start_seconds;
+}
+
+// Ciclos do laço fora das fases medidas; vitima já está contida em falta
+static uint64_t other_cycles(const Profile *profile) {
+    uint64_t measured = profile->cycles[PROF_PARSE] + profile->cycles[PROF_LOOKUP] +
+                        profile->cycles[PROF_FAULT] + profile->cycles[PROF_WRITEBACK];
+    return measured < profile->run_cycles ? profile->run_cycles - measured : 0;
+}
+
+static double share(uint64_t cycles, uint64_t total) {
+    return total ? (double)cycles / total : 0.0;
+}
+
+static double ratio(uint64_t value, uint64_t count) {
+    return count ? (double)value / count : 0.0;
+}
+
+// Strings entram no JSON e no CSV como estão, só com aspas e barras escapadas
+static void write_string(FILE *out, const char *text) {
+    fputc('"', out);
+    for (const char *c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', out);
+        }
+        fputc(*c, out);
+    }
+    fputc('"', out);
+}
+
+static void write_json(const Profile *profile, FILE *out, const char *simulator,
+                       const char *policy, const char *trace, unsigned long accesses) {
+
+    double rate = profile->run_seconds > 0 ? profile->run_cycles / profile->run_seconds : 0.0;
+
+    fprintf(out, "{\n  \"simulador\": ");
+    write_string(out, simulator);
+    fprintf(out, ",\n  \"politica\": ");
+    write_string(out, policy);
+    fprintf(out, ",\n  \"trace\": ");
+    write_string(out, trace);
+    fprintf(out, ",\n  \"acessos\": %lu,\n", accesses);
+    fprintf(out, "  \"relogio\": \"%s\",\n", PROF_CLOCK_NAME);
+    fprintf(out, "  \"ciclos_por_segundo\": %.0f,\n", rate);
+    fprintf(out, "  \"custo_leitura_ciclos\": %llu,\n", (unsigned long long)profile->read_cost);
+    fprintf(out, "  \"total\": {\"ciclos\": %llu, \"segundos\": %.6f, \"ciclos_por_acesso\": %.2f},\n",
+            (unsigned long long)profile->run_cycles, profile->run_seconds, ratio(profile->run_cycles, accesses));
+
+    fprintf(out, "  \"fases\": {\n");
+    for (int phase = 0; phase < PROF_PHASES; phase++) {
+        fprintf(out, "    \"%s\": {\"chamadas\": %llu, \"ciclos\": %llu, \"ciclos_por_chamada\": %.2f, \"fracao\": %.4f},\n",
+                phase_names[phase], (unsigned long long)profile->calls[phase],
+                (unsigned long long)profile->cycles[phase],
+                ratio(profile->cycles[phase], profile->calls[phase]),
+                share(profile->cycles[phase], profile->run_cycles));
+    }
+    uint64_t other = other_cycles(profile);
+    fprintf(out, "    \"resto\": {\"ciclos\": %llu, \"fracao\": %.4f}\n  },\n",
+            (unsigned long long)other, share(other, profile->run_cycles));
+
+    fprintf(out, "  \"contadores\": {\n");
+    for (int counter = 0; counter < PROF_COUNTERS; counter++) {
+        fprintf(out, "    \"%s\": %llu,\n", counter_names[counter], (unsigned long long)profile->counters[counter]);
+    }
+    fprintf(out, "    \"profundidade_media\": %.3f,\n",
+            ratio(profile->counters[PROF_WALK_LEVELS], profile->counters[PROF_WALKS]));
+    fprintf(out, "    \"varredura_media\": %.3f\n  }\n}\n",
+            profile->counters[PROF_VICTIM_SEARCHES]
+                ? 1.0 + ratio(profile->counters[PROF_SKIPPED_FRAMES], profile->counters[PROF_VICTIM_SEARCHES])
+                : 0.0);
+}
+
+static void write_csv_header(FILE *out) {
+    fprintf(out, "simulador,politica,trace,acessos,relogio,ciclos_por_segundo,custo_leitura_ciclos,ciclos_total,segundos_total");
+    for (int phase = 0; phase < PROF_PHASES; phase++) {
+        fprintf(out, ",%s_chamadas,%s_ciclos", phase_names[phase], phase_names[phase]);
+    }
+    fprintf(out, ",resto_ciclos");
+    for (int counter = 0; counter < PROF_COUNTERS; counter++) {
+        fprintf(out, ",%s", counter_names[counter]);
+    }
+    fprintf(out, "\n");
+}
+
+static void write_csv_row(const Profile *profile, FILE *out, const char *simulator,
+                          const char *policy, const char *trace, unsigned long accesses) {
+
+    double rate = profile->run_seconds > 0 ? profile->run_cycles / profile->run_seconds : 0.0;
+
+    fprintf(out, "%s,%s,", simulator, policy);
+    write_string(out, trace);
+    fprintf(out, ",%lu,%s,%.0f,%llu,%llu,%.6f", accesses, PROF_CLOCK_NAME, rate,
+            (unsigned long long)profile->read_cost, (unsigned long long)profile->run_cycles, profile->run_seconds);
+    for (int phase = 0; phase < PROF_PHASES; phase++) {
+        fprintf(out, ",%llu,%llu", (unsigned long long)profile->calls[phase], (unsigned long long)profile->cycles[phase]);
+    }
+    fprintf(out, ",%llu", (unsigned long long)other_cycles(profile));
+    for (int counter = 0; counter < PROF_COUNTERS; counter++) {
+        fprintf(out, ",%llu", (unsigned long long)profile->counters[counter]);
+    }
+    fprintf(out, "\n");
+}
+
+int prof_write(const Profile *profile, int format, const char *path, const char *simulator,
+               const char *policy, const char *trace, unsigned long accesses) {
+
+    FILE *out = stdout;
+    if (path) {
+        out = fopen(path, format == PROF_FORMAT_CSV ? "a" : "w");
+        if (!out) {
+            perror("Erro ao abrir o arquivo do perfil");
+            return -1;
+        }
+    }
+
+    if (format == PROF_FORMAT_JSON) {
+        write_json(profile, out, simulator, policy, trace, accesses);
+    } else {
+        // Na saída padrão e no arquivo novo o cabeçalho vem antes da linha
+        if (!path || (fseek(out, 0, SEEK_END) == 0 && ftell(out) == 0)) {
+            write_csv_header(out);
+        }
+        write_csv_row(profile, out, simulator, policy, trace, accesses);
+    }
+
+    if (path && fclose(out) != 0) {
+        perror("Erro ao gravar o perfil");
+        return -1;
+    }
+    return 0;
+}
+
+#else
+
+// Sem a instrumentação prof_parse_spec já recusa o perfil, então nada chega aqui
+int prof_write(const Profile *profile, int format, const char *path, const char *simulator,
+               const char *policy, const char *trace, unsigned long accesses) {
+    return -1;
+}
+
+#endif
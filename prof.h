@@ -0,0 +1,108 @@
+#ifndef PROF_H
+#define PROF_H
+
+#include <stdint.h>
+
+// Instrumentação do laço de acessos, compartilhada pelas quatro tabelas. Só existe quando o
+// programa é compilado com -DSIM_PROFILE (make PROFILE=1): sem ele as macros PROF_* não geram
+// código nenhum e o laço é o mesmo de sempre.
+// As fases são medidas com o contador de ciclos do processador (rdtsc; fora do x86, nanossegundos
+// do relógio monotônico) e acumuladas por thread, como o resto do estado dos simuladores:
+//   leitura   - trace_next_run: leitura e decodificação do trace
+//   busca     - TLB e percurso da tabela, até saber se a página está presente
+//   falta     - tratamento da falta, com a escolha da vítima e o despejo
+//   vitima    - só a escolha da vítima (contida em falta)
+//   limpador  - rodadas do limpador de sujas
+// O que sobra do laço (bits de referenciada e suja, listas das políticas, amostragem) é o resto.
+// Cada medição custa algumas dezenas de ciclos, que entram na fase medida; o custo de uma leitura
+// do contador sai no relatório para dar a escala
+
+enum { PROF_PARSE, PROF_LOOKUP, PROF_FAULT, PROF_EVICT, PROF_WRITEBACK, PROF_PHASES };
+
+enum {
+    PROF_WALKS,             // percursos da tabela (buscas que não acertam na TLB)
+    PROF_WALK_LEVELS,       // níveis lidos nesses percursos (na inverted, âncora e elos da cadeia)
+    PROF_VICTIM_SEARCHES,   // escolhas de vítima com a memória cheia
+    PROF_SKIPPED_FRAMES,    // quadros (ou nós de repl.c) examinados e pulados nessas escolhas
+    PROF_TABLE_ALLOCS,      // tabelas de páginas tiradas do slab
+    PROF_TABLE_FREES,
+    PROF_SLAB_CHUNKS,       // pedaços pedidos ao malloc pelo slab
+    PROF_COUNTERS
+};
+
+enum { PROF_FORMAT_NONE, PROF_FORMAT_JSON, PROF_FORMAT_CSV };
+
+typedef struct {
+    uint64_t cycles[PROF_PHASES];
+    uint64_t calls[PROF_PHASES];
+    uint64_t counters[PROF_COUNTERS];
+    uint64_t run_cycles;        // o kernel inteiro
+    double run_seconds;
+    uint64_t read_cost;         // ciclos de uma leitura do contador
+} Profile;
+
+extern _Thread_local Profile sim_profile;
+
+// Lê "formato[:arquivo]" (json ou csv). Sem arquivo o perfil vai para a saída padrão, depois do
+// relatório; num arquivo CSV as linhas são acrescentadas e o cabeçalho só é escrito no arquivo vazio.
+// Retorna 0 ou -1, com a mensagem de erro já impressa (também quando a instrumentação não foi compilada)
+int prof_parse_spec(const char *spec, int *format, const char **path);
+
+// Zera o perfil da thread e mede o custo de ler o contador
+void prof_reset(Profile *profile);
+
+// Grava o perfil de uma simulação. Retorna 0 em caso de sucesso
+int prof_write(const Profile *profile, int format, const char *path, const char *simulator,
+               const char *policy, const char *trace, unsigned long accesses);
+
+#ifdef SIM_PROFILE
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROF_CLOCK_NAME "rdtsc"
+static inline uint64_t prof_cycles(void) {
+    return __rdtsc();
+}
+#else
+#include <time.h>
+#define PROF_CLOCK_NAME "ns"
+static inline uint64_t prof_cycles(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+static inline void prof_add(int phase, uint64_t start) {
+    sim_profile.cycles[phase] += prof_cycles() - start;
+    sim_profile.calls[phase]++;
+}
+
+void prof_run_begin(Profile *profile);
+void prof_run_end(Profile *profile);
+
+// PROF_START/PROF_STOP delimitam uma fase com começo e fim em pontos diferentes do código;
+// PROF_TIME mede uma expressão e devolve o valor dela; PROF_CALL mede uma chamada sem valor
+#define PROF_START(name) uint64_t name = prof_cycles()
+#define PROF_STOP(phase, name) prof_add(phase, name)
+#define PROF_TIME(phase, expr) \
+    ({ uint64_t prof_start_ = prof_cycles(); __typeof__(expr) prof_value_ = (expr); prof_add(phase, prof_start_); prof_value_; })
+#define PROF_CALL(phase, call) \
+    do { uint64_t prof_start_ = prof_cycles(); call; prof_add(phase, prof_start_); } while (0)
+#define PROF_COUNT(counter, n) (sim_profile.counters[counter] += (n))
+#define PROF_RUN_BEGIN() (prof_reset(&sim_profile), prof_run_begin(&sim_profile))
+#define PROF_RUN_END() prof_run_end(&sim_profile)
+
+#else
+
+#define PROF_START(name) ((void)0)
+#define PROF_STOP(phase, name) ((void)0)
+#define PROF_TIME(phase, expr) (expr)
+#define PROF_CALL(phase, call) call
+#define PROF_COUNT(counter, n) ((void)0)
+#define PROF_RUN_BEGIN() ((void)0)
+#define PROF_RUN_END() ((void)0)
+
+#endif
+
+#endif
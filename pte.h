@@ -0,0 +1,34 @@
+#ifndef PTE_H
+#define PTE_H
+
+#include <stdint.h>
+
+// Entrada de tabela de páginas compacta, compartilhada pelo dense e pelas tabelas hierárquicas.
+// Como numa PTE de hardware, os bits de controle ficam no topo e o número do quadro embaixo:
+//
+//   31      30     29            28..0
+//   válida  suja   referenciada  quadro
+//
+// Uma entrada zerada é inválida, então tabelas vindas de calloc/mmap anônimo já estão prontas.
+// Os instantes de acesso do LRU ficam no quadro, não na entrada
+typedef uint32_t PageTableEntry;
+
+#define PTE_VALID      (1u << 31)
+#define PTE_DIRTY      (1u << 30)
+#define PTE_REFERENCED (1u << 29)
+#define PTE_FRAME_MASK (PTE_REFERENCED - 1)
+
+static inline int pte_valid(PageTableEntry pte) {
+    return (pte & PTE_VALID) != 0;
+}
+
+static inline unsigned pte_frame(PageTableEntry pte) {
+    return pte & PTE_FRAME_MASK;
+}
+
+// Entrada válida para o quadro, com os bits de suja e referenciada limpos
+static inline PageTableEntry pte_make(unsigned frame) {
+    return PTE_VALID | (frame & PTE_FRAME_MASK);
+}
+
+#endif
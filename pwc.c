@@ -0,0 +1,38 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pwc.h"
+
+void pwc_init(PwcLevel *cache, unsigned entries) {
+
+    memset(cache, 0, sizeof(*cache));
+    if (entries == 0) {
+        return;
+    }
+
+    unsigned size = 1;
+    while (size * 2 <= entries) {
+        size *= 2;
+    }
+
+    cache->entries = (PwcEntry *)calloc(size, sizeof(PwcEntry));
+    if (!cache->entries) {
+        fprintf(stderr, "Erro ao alocar memória para o cache de percurso\n");
+        exit(EXIT_FAILURE);
+    }
+    cache->mask = size - 1;
+}
+
+void pwc_free(PwcLevel *cache) {
+    free(cache->entries);
+    cache->entries = NULL;
+}
+
+const char *pwc_hit_rate_text(const PwcLevel *cache, char *text) {
+    if (!cache->lookups) {
+        return "sem consultas";
+    }
+    snprintf(text, PWC_RATE_TEXT, "%.2f%% de acertos em %lu consultas", pwc_hit_rate(cache), cache->lookups);
+    return text;
+}
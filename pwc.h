@@ -0,0 +1,81 @@
+#ifndef PWC_H
+#define PWC_H
+
+#include <stdint.h>
+
+// Cache de percurso (page-walk cache) de um nível das tabelas hierárquicas, como os caches de
+// PML4/PDPT/PDE do x86: guarda o ponteiro para a tabela do nível seguinte, indexado pelo prefixo
+// do endereço virtual que leva até ela. Com acerto, o percurso pula os níveis de cima.
+// É mapeado diretamente (posição = prefixo módulo o número de entradas, potência de 2)
+// e não substitui nenhum dado: a tabela continua sendo a fonte da verdade
+
+typedef struct {
+    uint64_t prefix;
+    void *table;        // NULL = posição vazia
+} PwcEntry;
+
+typedef struct {
+    PwcEntry *entries;  // NULL = cache desligado
+    unsigned mask;
+    unsigned long lookups;
+    unsigned long hits;
+} PwcLevel;
+
+// entries é arredondado para a potência de 2 de baixo; 0 desliga o cache
+void pwc_init(PwcLevel *cache, unsigned entries);
+
+// Libera as entradas; as estatísticas continuam disponíveis para o relatório
+void pwc_free(PwcLevel *cache);
+
+static inline void *pwc_lookup(PwcLevel *cache, uint64_t prefix) {
+    if (!cache->entries) {
+        return NULL;
+    }
+    cache->lookups++;
+    PwcEntry *entry = &cache->entries[prefix & cache->mask];
+    if (entry->table && entry->prefix == prefix) {
+        cache->hits++;
+        return entry->table;
+    }
+    return NULL;
+}
+
+static inline void pwc_fill(PwcLevel *cache, uint64_t prefix, void *table) {
+    if (cache->entries) {
+        PwcEntry *entry = &cache->entries[prefix & cache->mask];
+        entry->prefix = prefix;
+        entry->table = table;
+    }
+}
+
+// Conta count consultas seguidas que acertam, como as de vários acessos seguidos à mesma página
+static inline void pwc_repeat_hits(PwcLevel *cache, unsigned long count) {
+    if (cache->entries) {
+        cache->lookups += count;
+        cache->hits += count;
+    }
+}
+
+// Esquece a tabela do prefixo (ela foi liberada)
+static inline void pwc_forget(PwcLevel *cache, uint64_t prefix) {
+    if (cache->entries) {
+        PwcEntry *entry = &cache->entries[prefix & cache->mask];
+        if (entry->prefix == prefix) {
+            entry->table = NULL;
+        }
+    }
+}
+
+static inline double pwc_hit_rate(const PwcLevel *cache) {
+    return cache->lookups ? 100.0 * cache->hits / cache->lookups : 0.0;
+}
+
+#define PWC_RATE_TEXT 80
+
+// Taxa de acertos formatada para o relatório, com o número de consultas: os níveis de cima só são
+// consultados quando os de baixo erram, e 0% em poucas consultas (as faltas compulsórias) não quer
+// dizer que o nível sempre erra; "sem consultas" quando o nível não foi consultado. text deve ter
+// PWC_RATE_TEXT bytes
+const char *pwc_hit_rate_text(const PwcLevel *cache, char *text);
+
+#endif
@@ -0,0 +1,640 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stddef.h>
+
+#include "frames.h"
+#include "lru.h"
+#include "opt.h"
+#include "prof.h"
+#include "pte.h"
+#include "pwc.h"
+#include "repl.h"
+#include "series.h"
+#include "shards.h"
+#include "slab.h"
+#include "trace.h"
+#include "writeback.h"
+#include "sim.h"
+
+// Constantes globais
+// Endereços virtuais de 48 bits, como os do x86-64: os três níveis de baixo têm LEVEL_BITS bits
+// cada e o primeiro fica com o resto, o que dá 9/9/9/9 com páginas de 4 KB
+#define VIRTUAL_ADDRESS_BITS 48
+#define LEVEL_BITS 9
+#define READ 'R'
+#define WRITE 'W'
+
+// Estruturas de dados
+// As entradas da tabela são PageTableEntry compactas (pte.h); aqui só o quadro e o bit de válida
+// são usados, já que suja e referenciada ficam no quadro
+
+// Tabela de diretório (primeiro, segundo ou terceiro nível). As do segundo e do terceiro nível
+// vêm do mesmo slab num único bloco, com o vetor de entradas logo depois do cabeçalho; live conta
+// as tabelas filhas presentes, parent é a tabela mãe e slot a posição nela que aponta para a
+// tabela, para que a liberação suba os níveis sem percorrê-los de novo
+typedef struct PageTableLevel {
+    void **entries;
+    unsigned size;
+    unsigned live;
+    struct PageTableLevel *parent;
+    void **slot;
+} PageTableLevel;
+
+// Tabela do quarto nível, alocada do slab: conta as entradas válidas para voltar à lista livre
+// quando a última página dela for despejada, e guarda a tabela mãe e a posição nela, para ser
+// desligada sem percorrer a tabela de novo
+typedef struct PageTableLeaf {
+    PageTableLevel *parent;
+    void **slot;
+    unsigned live;
+    PageTableEntry entries[];
+} PageTableLeaf;
+
+// Variáveis globais
+static _Thread_local unsigned page_offset_bits;        
+static _Thread_local unsigned level1_bits;
+static _Thread_local PageTableLevel *level1_table;   
+static _Thread_local Slab directory_slab, leaf_slab;
+static _Thread_local size_t page_table_bytes = 0;
+static _Thread_local size_t peak_page_table_bytes = 0;
+static _Thread_local unsigned memory_size_kb;          
+static _Thread_local unsigned page_size_kb;             
+static _Thread_local char replacement_policy[10];     
+static _Thread_local long unsigned total_accesses = 0;    
+static _Thread_local long unsigned page_faults = 0;          
+static _Thread_local long unsigned pages_written = 0;     
+static _Thread_local long unsigned page_table_walks = 0;
+
+// Caches de percurso, como os de PML4, PDPT e PDE do x86-64: level1_cache guarda tabelas do
+// segundo nível pelo índice do primeiro, level2_cache as do terceiro pelos índices dos dois
+// primeiros e leaf_cache as do quarto pelos índices dos três primeiros
+static _Thread_local PwcLevel level1_cache, level2_cache, leaf_cache;
+
+// Quadros de memória em estrutura de vetores (frames.h); frame_entries guarda a entrada da página
+// contida em cada quadro, para o despejo não percorrer a tabela
+static _Thread_local FrameTable frames;
+static _Thread_local PageTableEntry **frame_entries;
+static _Thread_local unsigned num_frames;
+static _Thread_local LruList lru_list;
+static _Thread_local SimRandom rng;
+static _Thread_local unsigned fifo_next_frame = 0;
+static _Thread_local unsigned clock_pointer = 0;
+static _Thread_local int policy_id;
+static _Thread_local Tlb tlb;
+static _Thread_local Repl repl;
+static _Thread_local Opt opt;
+static _Thread_local Writeback writeback;
+static _Thread_local Shards shards;
+static _Thread_local Series series;
+static _Thread_local int address_rejected;
+
+// Funções auxiliares
+static unsigned calculate_offset_bits(unsigned page_size_kb) {
+    unsigned tmp = page_size_kb;
+    unsigned s = 0;
+    while (tmp > 1) {
+        tmp >>= 1;
+        s++;
+    }
+    return s;
+}
+
+
+// Inicializar a memória física e tabela de páginas
+static void initialize_page_table() {
+
+    level1_table = (PageTableLevel *)calloc(1, sizeof(PageTableLevel));
+    level1_table->size = (1 << level1_bits);
+    level1_table->entries = (void **)calloc(level1_table->size, sizeof(void *));
+    slab_init(&directory_slab, sizeof(PageTableLevel) + (1 << LEVEL_BITS) * sizeof(void *));
+    slab_init(&leaf_slab, sizeof(PageTableLeaf) + (1 << LEVEL_BITS) * sizeof(PageTableEntry));
+
+    page_table_bytes = sizeof(PageTableLevel) + level1_table->size * sizeof(void *);
+    peak_page_table_bytes = page_table_bytes;
+
+    num_frames = shards_frames(&shards, memory_size_kb / page_size_kb);
+    frames_init(&frames, num_frames);
+    frame_entries = (PageTableEntry **)frames_alloc_array(num_frames, sizeof(PageTableEntry *));
+
+    total_accesses = 0;
+    address_rejected = 0;
+    page_faults = 0;
+    pages_written = 0;
+    page_table_walks = 0;
+    fifo_next_frame = 0;
+    clock_pointer = 0;
+
+    if (policy_id == POLICY_LRU) {
+        lru_init(&lru_list, num_frames);
+    }
+    if (sim_policy_uses_repl(policy_id)) {
+        repl_init(&repl, policy_id - POLICY_ARC, num_frames);
+    }
+}
+
+// Libera a tabela de páginas e os quadros; os totais continuam disponíveis para o relatório
+static void release_page_table() {
+
+    slab_destroy(&leaf_slab);
+    slab_destroy(&directory_slab);
+    free(level1_table->entries);
+    free(level1_table);
+    level1_table = NULL;
+
+    frames_free(&frames);
+    free(frame_entries);
+    frame_entries = NULL;
+
+    if (policy_id == POLICY_LRU) {
+        lru_free(&lru_list);
+    }
+    if (sim_policy_uses_repl(policy_id)) {
+        repl_free(&repl);
+    }
+    if (policy_id == POLICY_OPT) {
+        opt_free(&opt);
+    }
+    tlb_free(&tlb);
+    pwc_free(&level1_cache);
+    pwc_free(&level2_cache);
+    pwc_free(&leaf_cache);
+}
+
+static void *alloc_table(Slab *slab) {
+    void *table = slab_alloc(slab);
+    page_table_bytes += slab->block_size;
+    if (page_table_bytes > peak_page_table_bytes) {
+        peak_page_table_bytes = page_table_bytes;
+    }
+    return table;
+}
+
+static void free_table(Slab *slab, void *table) {
+    slab_free(slab, table);
+    page_table_bytes -= slab->block_size;
+}
+
+// Tabela filha na posição index do diretório, criada do slab se ainda não existe
+static void *get_or_create_directory(PageTableLevel *table, unsigned index) {
+    if (table->entries[index] == NULL) {
+        PageTableLevel *child = (PageTableLevel *)alloc_table(&directory_slab);
+        child->size = (1 << LEVEL_BITS);
+        child->entries = (void **)(child + 1);
+        child->parent = table;
+        child->slot = &table->entries[index];
+        table->entries[index] = child;
+        table->live++;
+    }
+    return table->entries[index];
+}
+
+// Tabela do quarto nível da página, descendo pelos níveis de cima e criando as tabelas que faltam.
+// É o caminho lento do percurso, fora do laço: só roda quando o cache de percurso não tem a
+// tabela, e cada nível só é lido quando o cache do nível de baixo também erra
+static PageTableLeaf *walk_upper_levels(uint64_t page) {
+
+    PROF_COUNT(PROF_WALK_LEVELS, 1);
+    PageTableLevel *level3_table = (PageTableLevel *)pwc_lookup(&level2_cache, page >> (2 * LEVEL_BITS));
+    if (!level3_table) {
+        PROF_COUNT(PROF_WALK_LEVELS, 1);
+        PageTableLevel *level2_table = (PageTableLevel *)pwc_lookup(&level1_cache, page >> (3 * LEVEL_BITS));
+        if (!level2_table) {
+            PROF_COUNT(PROF_WALK_LEVELS, 1);
+            level2_table = (PageTableLevel *)get_or_create_directory(level1_table, page >> (3 * LEVEL_BITS));
+            pwc_fill(&level1_cache, page >> (3 * LEVEL_BITS), level2_table);
+        }
+        level3_table = (PageTableLevel *)get_or_create_directory(level2_table, (page >> (2 * LEVEL_BITS)) & ((1 << LEVEL_BITS) - 1));
+        pwc_fill(&level2_cache, page >> (2 * LEVEL_BITS), level3_table);
+    }
+
+    unsigned level3_index = (page >> LEVEL_BITS) & ((1 << LEVEL_BITS) - 1);
+    if (level3_table->entries[level3_index] == NULL) {
+        PageTableLeaf *level4_table = (PageTableLeaf *)alloc_table(&leaf_slab);
+        level4_table->parent = level3_table;
+        level4_table->slot = &level3_table->entries[level3_index];
+        level3_table->entries[level3_index] = level4_table;
+        level3_table->live++;
+    }
+    PageTableLeaf *level4_table = (PageTableLeaf *)level3_table->entries[level3_index];
+    pwc_fill(&leaf_cache, page >> LEVEL_BITS, level4_table);
+    return level4_table;
+}
+
+// Entrada da página, criando as tabelas intermediárias se preciso; devolve também a do quarto nível.
+// É o único percurso da tabela: page_table_walks conta um por acesso que não acerta na TLB.
+// Com acerto no cache de percurso o percurso lê só a entrada da página
+SIM_INLINE PageTableEntry *get_or_create_page_entry(uint64_t page, PageTableLeaf **leaf_out) {
+
+    page_table_walks++;
+    PROF_COUNT(PROF_WALKS, 1);
+    PROF_COUNT(PROF_WALK_LEVELS, 1);
+
+    PageTableLeaf *level4_table = (PageTableLeaf *)pwc_lookup(&leaf_cache, page >> LEVEL_BITS);
+    if (!level4_table) {
+        level4_table = walk_upper_levels(page);
+    }
+
+    *leaf_out = level4_table;
+    return &level4_table->entries[page & ((1 << LEVEL_BITS) - 1)];
+}
+
+// Invalida a entrada da página contida no quadro, chegando a ela e às suas tabelas pelo próprio
+// quadro; as tabelas que ficam vazias voltam para o slab e saem do cache de percurso, subindo
+// até o segundo nível (o primeiro fica alocado a simulação toda)
+static void invalidate_frame_entry(int frame_index) {
+
+    PageTableEntry *entry = frame_entries[frame_index];
+    uint64_t page = frames.page_number[frame_index];
+    unsigned level4_index = page & ((1 << LEVEL_BITS) - 1);
+    PageTableLeaf *level4_table = (PageTableLeaf *)((char *)(entry - level4_index) - offsetof(PageTableLeaf, entries));
+
+    *entry = 0;
+    frame_entries[frame_index] = NULL;
+    if (--level4_table->live > 0) {
+        return;
+    }
+
+    // As entradas já estão todas zeradas; só o cabeçalho precisa ser limpo antes de devolver
+    PageTableLevel *table = level4_table->parent;
+    *level4_table->slot = NULL;
+    memset(level4_table, 0, sizeof(PageTableLeaf));
+    free_table(&leaf_slab, level4_table);
+    pwc_forget(&leaf_cache, page >> LEVEL_BITS);
+
+    // Terceiro e depois segundo nível, cada um esquecido no cache que aponta para ele
+    PwcLevel *caches[] = {&level2_cache, &level1_cache};
+    for (int level = 0; level < 2 && --table->live == 0; level++) {
+        PageTableLevel *parent = table->parent;
+        *table->slot = NULL;
+        pwc_forget(caches[level], page >> ((level + 2) * LEVEL_BITS));
+        memset(table, 0, sizeof(PageTableLevel));
+        free_table(&directory_slab, table);
+        table = parent;
+    }
+}
+
+// Algoritmos de seleção de página a ser retirada da memória
+SIM_INLINE int choose_frame_to_replace(uint64_t page, const int policy) {
+    switch (policy) {
+    case POLICY_LRU:
+        // A cauda da lista de recência é a vítima, também com quadros livres. Só os acertos levam
+        // o quadro para a cabeça: a carga numa falta não o move, então ele fica na cauda até o
+        // primeiro acerto
+        return lru_victim(&lru_list);
+
+    case POLICY_FIFO: {
+        int victim = fifo_next_frame;
+        fifo_next_frame = (fifo_next_frame + 1) % num_frames;
+        return victim;
+    }
+
+    case POLICY_RANDOM:
+        return sim_random_next(&rng) % num_frames;
+
+    case POLICY_2A:
+        return frames_clock_victim(&frames, &clock_pointer);
+
+    case POLICY_OPT:
+        return opt_victim(&opt);
+
+    default:
+        // Políticas de repl.c: escolhem também entre os quadros livres
+        return repl_miss(&repl, page);
+    }
+}
+
+//Lida com a falta de uma página na memória
+SIM_INLINE void handle_page_fault(PageTableEntry *entry, PageTableLeaf *leaf, uint64_t page, const int policy) {
+
+    // Conta a nova entrada antes do despejo: se a vítima for da mesma tabela, ela não pode ser liberada
+    leaf->live++;
+
+    int frame_to_replace = PROF_TIME(PROF_EVICT, choose_frame_to_replace(page, policy));
+
+    if (frames.valid[frame_to_replace]) {
+        PROF_COUNT(PROF_VICTIM_SEARCHES, 1);
+        if (tlb_enabled(&tlb)) {
+            tlb_invalidate(&tlb, frames.page_number[frame_to_replace]);
+        }
+        invalidate_frame_entry(frame_to_replace);
+    }
+
+    if (frames.valid[frame_to_replace]) {
+        if (frames.modified[frame_to_replace]) {
+            pages_written++;
+        }
+        writeback_evicted(&writeback, frames.modified[frame_to_replace]);
+    }
+
+    frames.page_number[frame_to_replace] = page;
+    frames.valid[frame_to_replace] = 1;
+    frames.modified[frame_to_replace] = 0;
+
+    frame_entries[frame_to_replace] = entry;
+
+    *entry = pte_make(frame_to_replace);
+}
+
+SIM_UNUSED static void print_inverted_table() {
+    printf("Tabela Invertida:\n");
+    printf("-------------------------------------------------\n");
+    printf("| Quadro | Página Virtual | Suja | Referenciada |\n");
+    printf("-------------------------------------------------\n");
+    for (unsigned i = 0; i < num_frames; i++) {
+        printf("| %-6u | %-14llu | %-4d | %-12d |\n",
+               i,
+               (unsigned long long)frames.page_number[i],
+               frames.modified[i],
+               frames.referenced[i]);
+    }
+    printf("-------------------------------------------------\n");
+}
+
+// Liga o bit de suja do quadro, contando a página que passa a estar suja
+SIM_INLINE void mark_modified(int frame_index, int written) {
+    uint8_t was_modified = frames.modified[frame_index];
+    frames.modified[frame_index] = was_modified | (written != 0);
+    writeback_dirtied(&writeback, (written != 0) & !was_modified);
+}
+
+// Rodada do limpador: escreve as páginas sujas dos quadros a partir do ponteiro dele. O bit de
+// suja fica no quadro, não na TLB, então as traduções continuam valendo
+SIM_COLD static void run_writeback() {
+    PROF_START(start);
+    unsigned pending = writeback_begin(&writeback, total_accesses);
+    for (unsigned step = 0; pending > 0 && step < num_frames; step++) {
+        unsigned index = writeback.hand;
+        writeback.hand = index + 1 == num_frames ? 0 : index + 1;
+
+        if (frames.valid[index] && frames.modified[index]) {
+            frames.modified[index] = 0;
+            pages_written++;
+            writeback_cleaned(&writeback);
+            pending--;
+        }
+    }
+    PROF_STOP(PROF_WRITEBACK, start);
+}
+
+// Contadores acumulados da série por janelas, no tempo do trace (com os acessos fora da amostra)
+static SeriesSample window_sample() {
+    SeriesSample sample = {total_accesses + shards.skipped_accesses, total_accesses, page_faults, pages_written, writeback.dirty};
+    return sample;
+}
+
+// Fim de uma janela da série
+SIM_COLD static void record_window() {
+    SeriesSample sample = window_sample();
+    series_record(&series, &sample);
+}
+
+// Endereço fora da forma canônica de 48 bits (os bits de cima repetem o bit 47, como no x86-64):
+// a simulação para com erro em vez de truncá-lo, o que juntaria páginas diferentes numa só
+SIM_COLD static void reject_address(uint64_t addr) {
+    fprintf(stderr, "Endereço 0x%llx não é canônico para os %d bits da tabela de quatro níveis\n",
+            (unsigned long long)addr, VIRTUAL_ADDRESS_BITS);
+    address_rejected = 1;
+}
+
+// hits acessos seguidos a uma página presente
+SIM_INLINE void reference_frame(int frame_index, unsigned long hits, const int policy) {
+    frames.referenced[frame_index] = 1;
+    if (policy == POLICY_LRU) {
+        lru_touch(&lru_list, frame_index);
+    } else if (sim_policy_uses_repl(policy)) {
+        repl_hits(&repl, frame_index, hits);
+    }
+}
+
+// Processamento do arquivo de entrada, instanciado uma vez por política por SIM_DEFINE_KERNELS.
+// Os acessos seguidos à mesma página depois do primeiro são acertos e são aplicados de uma vez
+SIM_INLINE void process_memory_access(TraceReader *file, const int policy) {
+    uint64_t address;
+    char access_type;
+    unsigned long repeats;
+    int repeats_written;
+
+    while (PROF_TIME(PROF_PARSE, trace_next_run(file, page_offset_bits, &address, &access_type, writeback_run_limit(&writeback, total_accesses),
+                                                &repeats, &repeats_written))) {
+        // Os endereços canônicos da metade de cima ficam acima dos da metade de baixo depois de
+        // cortados nos 48 bits, então o corte não junta páginas
+        uint64_t upper = (uint64_t)((int64_t)address >> (VIRTUAL_ADDRESS_BITS - 1));
+        if (upper != 0 && upper != UINT64_MAX) {
+            reject_address(address);
+            break;
+        }
+        address = (address & ((1ull << VIRTUAL_ADDRESS_BITS) - 1)) >> page_offset_bits;
+        if (shards_skip(&shards, address, repeats)) {
+            continue;
+        }
+
+        total_accesses++;
+
+        // Acerto na TLB: usa o quadro guardado sem percorrer a tabela
+        PROF_START(lookup);
+        TlbEntry *cached = tlb_enabled(&tlb) ? tlb_lookup(&tlb, address) : NULL;
+        int frame_index;
+
+        if (cached) {
+            PROF_STOP(PROF_LOOKUP, lookup);
+            frame_index = cached->frame;
+            reference_frame(frame_index, 1, policy);
+        } else {
+
+            PageTableLeaf *leaf;
+            PageTableEntry *entry = get_or_create_page_entry(address, &leaf);
+            int present = pte_valid(*entry);
+            PROF_STOP(PROF_LOOKUP, lookup);
+            if (!present) {
+
+                page_faults++;
+                PROF_CALL(PROF_FAULT, handle_page_fault(entry, leaf, address, policy));
+            } else {
+                reference_frame(pte_frame(*entry), 1, policy);
+            }
+
+            frame_index = pte_frame(*entry);
+            if (tlb_enabled(&tlb)) {
+                cached = tlb_insert(&tlb, address, frame_index, 0);
+            }
+        }
+
+        mark_modified(frame_index, access_type == WRITE);
+
+        if (repeats) {
+            total_accesses += repeats;
+            reference_frame(frame_index, repeats, policy);
+            mark_modified(frame_index, repeats_written);
+
+            // Sem TLB cada repetição seria um percurso que acerta no cache de percurso
+            if (cached) {
+                tlb_repeat_hits(&tlb, cached, repeats);
+            } else {
+                page_table_walks += repeats;
+                pwc_repeat_hits(&leaf_cache, repeats);
+            }
+        }
+
+        // O próximo uso da página é o do último acesso da sequência
+        if (policy == POLICY_OPT) {
+            opt_touch(&opt, frame_index, file->position - 1);
+        }
+        if (writeback_due(&writeback, total_accesses)) {
+            run_writeback();
+        }
+        if (series_due(&series, total_accesses + shards.skipped_accesses)) {
+            record_window();
+        }
+    }
+}
+
+SIM_DEFINE_KERNELS(process_memory_access);
+
+// Memória da tabela de páginas (primeiro nível e tabelas dos outros níveis em uso) e percursos
+// feitos nela - usada no relatório
+SIM_UNUSED static void calculate_table_size() {
+    printf("Memoria da tabela de paginas: %lu bytes (pico de %lu bytes)\n",
+           (unsigned long)page_table_bytes, (unsigned long)peak_page_table_bytes);
+    printf("Percursos da tabela de paginas: %lu (%lu em despejos)\n",
+           page_table_walks, page_table_walks - (total_accesses - tlb.hits));
+    if (leaf_cache.lookups) {
+        char leaf_rate[PWC_RATE_TEXT], level2_rate[PWC_RATE_TEXT], level1_rate[PWC_RATE_TEXT];
+        printf("Cache de percurso: nivel 3 com %s, nivel 2 com %s, nivel 1 com %s\n",
+               pwc_hit_rate_text(&leaf_cache, leaf_rate), pwc_hit_rate_text(&level2_cache, level2_rate),
+               pwc_hit_rate_text(&level1_cache, level1_rate));
+    }
+
+    // Cada percurso lê a entrada da página; os que erram no cache do nível 3 leem também o terceiro
+    // nível, os que erram ainda no do nível 2 leem o segundo e os que erram nos três leem o primeiro
+    unsigned long level3_reads = page_table_walks - leaf_cache.hits;
+    unsigned long level2_reads = level3_reads - level2_cache.hits;
+    unsigned long memory_references = page_table_walks + level3_reads + level2_reads + (level2_reads - level1_cache.hits);
+    printf("Referencias a memoria por traducao: %.2f (%.2f por percurso, 4 sem o cache de percurso)\n",
+           total_accesses ? (double)memory_references / total_accesses : 0.0,
+           page_table_walks ? (double)memory_references / page_table_walks : 0.0);
+}
+
+#ifndef SIM_LIBRARY
+// Função principal
+int main(int argc, char *argv[]) {
+    if (argc < 5 || argc > 11) {
+        fprintf(stderr, "Uso: %s <politica> <arquivo.log> <tamanho_pagina_kb> <tamanho_memoria_kb> [tlb=entradas/vias/politica] [pwc=entradas] [wb=periodo/lote/fundo/limite] [shards=taxa/paginas] [prof=json|csv[:arquivo]] [series=janela[/csv|/bin][:arquivo]]\n", argv[0]);
+        return 1;
+    }
+
+    const char *log_file = argv[2];
+
+    TraceReader file;
+    if (trace_open(&file, log_file) != 0) {
+        perror("Erro ao abrir arquivo de log");
+        return 1;
+    }
+
+    SimConfig config = {argv[1], atoi(argv[3]), atoi(argv[4]), SIM_DEFAULT_SEED, 0};
+    config.pwc_entries = SIM_DEFAULT_PWC_ENTRIES;
+    int invalid = sim_parse_options(argc, argv, 5, &config);
+    if (invalid) {
+        fprintf(stderr, "Opção inválida: %s\n", argv[invalid]);
+        return 1;
+    }
+    SimResult result;
+    if (quatroNiveis_simulate(&config, &file, &result) != 0) {
+        return 1;
+    }
+
+    //Relatório final
+    printf("Executando o simulador...\n");
+    printf("Arquivo de entrada: %s\n", log_file);
+    printf("Tamanho da memoria: %u KB\n", memory_size_kb / 1024);
+    printf("Tamanho das paginas: %u KB\n", page_size_kb / 1024);
+    printf("Tecnica de reposicao: %s\n", replacement_policy);
+    printf("Paginas lidas: %lu\n", shards_estimate(&shards, page_faults));
+    printf("Paginas escritas: %lu\n", shards_estimate(&shards, pages_written));
+    printf("Total de acessos à memória: %lu\n", total_accesses + shards.skipped_accesses);
+    shards_print_stats(&shards, total_accesses);
+    writeback_print_stats(&writeback);
+    calculate_table_size();
+    tlb_print_stats(&tlb);
+    if (sim_policy_uses_repl(policy_id)) {
+        repl_print_stats(&repl);
+    }
+    if (policy_id == POLICY_OPT) {
+        opt_print_stats(&opt);
+    }
+    trace_print_stats(&file);
+    if (config.profile_format != PROF_FORMAT_NONE &&
+        prof_write(&sim_profile, config.profile_format, config.profile_path, "quatroNiveis", argv[1], log_file, result.accesses) != 0) {
+        return 1;
+    }
+    trace_close(&file);
+
+    return 0;
+}
+#endif
+
+// Executa a simulação completa do trace (chamada pelo main e pelo sweep)
+int quatroNiveis_simulate(const SimConfig *config, TraceReader *trace, SimResult *result) {
+
+    policy_id = sim_policy_id(config->policy);
+    if (policy_id < 0) {
+        fprintf(stderr, "Algoritmo de substituição desconhecido: %s\n", config->policy);
+        return -1;
+    }
+
+    strcpy(replacement_policy, config->policy);
+    page_size_kb = config->page_size_kb * 1024;
+    memory_size_kb = config->memory_kb * 1024;
+    // Os três níveis de baixo têm tamanho fixo, então o primeiro precisa de pelo menos um bit
+    if (calculate_offset_bits(page_size_kb) + 3 * LEVEL_BITS >= VIRTUAL_ADDRESS_BITS) {
+        fprintf(stderr, "Tamanho de página grande demais para a tabela de quatro níveis: %u KB\n", config->page_size_kb);
+        return -1;
+    }
+    if (shards_init(&shards, config->sample_rate, config->sample_budget, trace, calculate_offset_bits(page_size_kb)) != 0) {
+        return -1;
+    }
+    sim_random_seed(&rng, config->seed);
+    tlb_init(&tlb, config->tlb_entries, config->tlb_ways, config->tlb_policy);
+    pwc_init(&level1_cache, config->pwc_entries);
+    pwc_init(&level2_cache, config->pwc_entries);
+    pwc_init(&leaf_cache, config->pwc_entries);
+
+    page_offset_bits = calculate_offset_bits(page_size_kb);
+    level1_bits = VIRTUAL_ADDRESS_BITS - page_offset_bits - 3 * LEVEL_BITS;
+
+    initialize_page_table();
+    writeback_init(&writeback, config->wb_period, config->wb_batch,
+                   config->wb_background_ratio, config->wb_dirty_ratio, num_frames);
+    if (policy_id == POLICY_OPT && opt_init(&opt, trace, page_offset_bits, num_frames) != 0) {
+        release_page_table();
+        return -1;
+    }
+
+    if (series_start(&series, config->series_window, config->series_format, config->series_path,
+                     shards.enabled ? shards.rate : 0) != 0) {
+        release_page_table();
+        return -1;
+    }
+
+    PROF_RUN_BEGIN();
+    kernels[policy_id](trace);
+    PROF_RUN_END();
+    SeriesSample last = window_sample();
+    if (series_finish(&series, &last) != 0 || address_rejected || trace->failed) {
+        release_page_table();
+        return -1;
+    }
+
+    result->page_faults = page_faults;
+    result->pages_written = pages_written;
+    result->accesses = total_accesses;
+    result->tlb_hits = tlb.hits;
+    result->ghost_hits = sim_policy_uses_repl(policy_id) ? repl.ghost_hits : 0;
+    result->page_table_bytes = peak_page_table_bytes;
+    sim_writeback_result(&writeback, result);
+    sim_shards_result(&shards, result);
+
+    release_page_table();
+    return 0;
+}
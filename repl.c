@@ -0,0 +1,695 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "prof.h"
+#include "repl.h"
+
+// Listas de cada política (índices de lists[]; todas usam link[0], menos as marcadas)
+enum { ARC_T1, ARC_T2, ARC_B1, ARC_B2 };
+enum { TWOQ_A1IN, TWOQ_AM, TWOQ_A1OUT };
+enum { LIRS_S, LIRS_Q, LIRS_GHOSTS };       // Q e GHOSTS usam link[1]
+
+// Estado das páginas no LIRS
+#define LIRS_LIR      1
+#define LIRS_IN_S     2
+#define LIRS_IN_Q     4
+#define LIRS_GHOST    8
+
+// Estado das páginas no CLOCK-Pro
+#define CLOCKPRO_HOT  1
+#define CLOCKPRO_COLD 2
+#define CLOCKPRO_TEST 4
+#define CLOCKPRO_REF  8
+
+static const char *kind_names[NUM_REPL_KINDS] = {"arc", "2q", "lirs", "clockpro"};
+
+const char *repl_kind_name(int kind) {
+    return kind >= 0 && kind < NUM_REPL_KINDS ? kind_names[kind] : "?";
+}
+
+// Listas encadeadas pelos índices dos nós, pelo link de número slot
+
+static void list_init(ReplList *list) {
+    list->head = -1;
+    list->tail = -1;
+    list->size = 0;
+}
+
+static void list_push_head(Repl *repl, ReplList *list, int slot, int n) {
+    ReplLink *link = &repl->nodes[n].link[slot];
+    link->prev = -1;
+    link->next = list->head;
+    if (list->head >= 0) {
+        repl->nodes[list->head].link[slot].prev = n;
+    } else {
+        list->tail = n;
+    }
+    list->head = n;
+    list->size++;
+}
+
+static void list_push_tail(Repl *repl, ReplList *list, int slot, int n) {
+    ReplLink *link = &repl->nodes[n].link[slot];
+    link->next = -1;
+    link->prev = list->tail;
+    if (list->tail >= 0) {
+        repl->nodes[list->tail].link[slot].next = n;
+    } else {
+        list->head = n;
+    }
+    list->tail = n;
+    list->size++;
+}
+
+static void list_remove(Repl *repl, ReplList *list, int slot, int n) {
+    ReplLink *link = &repl->nodes[n].link[slot];
+    if (link->prev >= 0) {
+        repl->nodes[link->prev].link[slot].next = link->next;
+    } else {
+        list->head = link->next;
+    }
+    if (link->next >= 0) {
+        repl->nodes[link->next].link[slot].prev = link->prev;
+    } else {
+        list->tail = link->prev;
+    }
+    list->size--;
+}
+
+// Põe o nó new no lugar de old, sem mudar a ordem da lista
+static void list_replace(Repl *repl, ReplList *list, int slot, int old, int new) {
+    ReplLink link = repl->nodes[old].link[slot];
+    repl->nodes[new].link[slot] = link;
+    if (link.prev >= 0) {
+        repl->nodes[link.prev].link[slot].next = new;
+    } else {
+        list->head = new;
+    }
+    if (link.next >= 0) {
+        repl->nodes[link.next].link[slot].prev = new;
+    } else {
+        list->tail = new;
+    }
+}
+
+// Fantasmas: nós de capacity em diante, achados pela página numa tabela hash encadeada
+
+// Os 32 bits de cima da página entram dobrados nos de baixo
+static inline unsigned ghost_bucket(const Repl *repl, uint64_t page) {
+    return ((uint32_t)(page ^ (page >> 32)) * 2654435761u >> 7) & repl->bucket_mask;
+}
+
+static int ghost_find(const Repl *repl, uint64_t page) {
+    int n = repl->buckets[ghost_bucket(repl, page)];
+    while (n >= 0 && repl->nodes[n].page != page) {
+        n = repl->nodes[n].hash_next;
+    }
+    return n;
+}
+
+// Nó fantasma para a página; as políticas limitam quantos existem, então sempre há um livre
+static int ghost_alloc(Repl *repl, uint64_t page) {
+    int n = repl->free_ghosts;
+    if (n < 0) {
+        fprintf(stderr, "Erro: fantasmas esgotados na política %s\n", repl_kind_name(repl->kind));
+        exit(EXIT_FAILURE);
+    }
+    repl->free_ghosts = repl->nodes[n].link[0].next;
+
+    ReplNode *node = &repl->nodes[n];
+    unsigned bucket = ghost_bucket(repl, page);
+    node->page = page;
+    node->flags = 0;
+    node->hash_next = repl->buckets[bucket];
+    repl->buckets[bucket] = n;
+    return n;
+}
+
+static void ghost_release(Repl *repl, int n) {
+    int *link = &repl->buckets[ghost_bucket(repl, repl->nodes[n].page)];
+    while (*link != n) {
+        link = &repl->nodes[*link].hash_next;
+    }
+    *link = repl->nodes[n].hash_next;
+
+    repl->nodes[n].link[0].next = repl->free_ghosts;
+    repl->free_ghosts = n;
+}
+
+// Próximo quadro ainda não usado, ou -1 com a memória cheia
+static inline int take_free_frame(Repl *repl) {
+    return repl->next_free < repl->capacity ? (int)repl->next_free++ : -1;
+}
+
+// Nó residente do quadro entra na lista, com a página
+static void admit(Repl *repl, int frame, uint64_t page, int list) {
+    repl->nodes[frame].page = page;
+    repl->nodes[frame].list = (uint8_t)list;
+    list_push_head(repl, &repl->lists[list], 0, frame);
+}
+
+// Sai da lista e vira fantasma na cabeça de outra
+static void retire_to_ghost(Repl *repl, int frame, int ghost_list) {
+    list_remove(repl, &repl->lists[repl->nodes[frame].list], 0, frame);
+    int g = ghost_alloc(repl, repl->nodes[frame].page);
+    repl->nodes[g].list = (uint8_t)ghost_list;
+    list_push_head(repl, &repl->lists[ghost_list], 0, g);
+}
+
+static void drop_ghost(Repl *repl, int g) {
+    list_remove(repl, &repl->lists[repl->nodes[g].list], 0, g);
+    ghost_release(repl, g);
+}
+
+// ARC (Megiddo e Modha): T1 tem as páginas vistas uma vez e T2 as vistas mais vezes; B1 e B2
+// lembram as despejadas de cada uma. Um acerto em B1 aumenta o alvo p de T1 e um em B2 o diminui,
+// então a divisão entre recência e frequência se adapta ao trace. |B1| + |B2| <= quadros
+
+static int arc_replace(Repl *repl, int hit_in_b2) {
+
+    int frame = take_free_frame(repl);
+    if (frame >= 0) {
+        return frame;
+    }
+
+    ReplList *t1 = &repl->lists[ARC_T1];
+    ReplList *t2 = &repl->lists[ARC_T2];
+    int from_t1 = t1->size > 0 && ((hit_in_b2 && t1->size == repl->target) || t1->size > repl->target);
+    if (t2->size == 0) {
+        from_t1 = 1;
+    }
+
+    frame = from_t1 ? t1->tail : t2->tail;
+    retire_to_ghost(repl, frame, from_t1 ? ARC_B1 : ARC_B2);
+    return frame;
+}
+
+static int arc_miss(Repl *repl, uint64_t page) {
+
+    ReplList *lists = repl->lists;
+    unsigned capacity = repl->capacity;
+    int g = ghost_find(repl, page);
+    int frame;
+
+    if (g >= 0) {
+        unsigned b1 = lists[ARC_B1].size, b2 = lists[ARC_B2].size;
+        int in_b2 = repl->nodes[g].list == ARC_B2;
+
+        repl->ghost_hits++;
+        repl->list_ghost_hits[in_b2]++;
+        if (!in_b2) {
+            unsigned delta = b1 >= b2 ? 1 : b2 / b1;
+            repl->target = repl->target + delta < capacity ? repl->target + delta : capacity;
+        } else {
+            unsigned delta = b2 >= b1 ? 1 : b1 / b2;
+            repl->target = repl->target > delta ? repl->target - delta : 0;
+        }
+
+        drop_ghost(repl, g);
+        frame = arc_replace(repl, in_b2);
+        admit(repl, frame, page, ARC_T2);
+        return frame;
+    }
+
+    if (lists[ARC_T1].size + lists[ARC_B1].size >= capacity) {
+        if (lists[ARC_T1].size < capacity) {
+            drop_ghost(repl, lists[ARC_B1].tail);
+            frame = arc_replace(repl, 0);
+        } else {
+            // T1 ocupa a memória toda: o despejado não deixa fantasma
+            frame = lists[ARC_T1].tail;
+            list_remove(repl, &lists[ARC_T1], 0, frame);
+        }
+    } else {
+        unsigned total = lists[ARC_T1].size + lists[ARC_T2].size + lists[ARC_B1].size + lists[ARC_B2].size;
+        if (total >= capacity) {
+            if (total >= 2 * capacity) {
+                drop_ghost(repl, lists[ARC_B2].tail);
+            }
+            frame = arc_replace(repl, 0);
+        } else {
+            frame = take_free_frame(repl);
+        }
+    }
+
+    admit(repl, frame, page, ARC_T1);
+    return frame;
+}
+
+static void arc_hit(Repl *repl, int frame) {
+    ReplNode *node = &repl->nodes[frame];
+    list_remove(repl, &repl->lists[node->list], 0, frame);
+    node->list = ARC_T2;
+    list_push_head(repl, &repl->lists[ARC_T2], 0, frame);
+}
+
+// 2Q (Johnson e Shasha): a primeira vez a página entra na fila A1in (FIFO, até Kin = 1/4 da
+// memória) e, ao sair dela, fica lembrada em A1out (até Kout = 1/2). Só uma página que volta
+// enquanto está em A1out entra em Am (LRU), então uma varredura passa por A1in sem tocar em Am
+
+static int twoq_reclaim(Repl *repl) {
+
+    int frame = take_free_frame(repl);
+    if (frame >= 0) {
+        return frame;
+    }
+
+    ReplList *lists = repl->lists;
+    if (lists[TWOQ_A1IN].size > repl->in_limit || lists[TWOQ_AM].size == 0) {
+        if (lists[TWOQ_A1OUT].size >= repl->out_limit) {
+            drop_ghost(repl, lists[TWOQ_A1OUT].tail);
+        }
+        frame = lists[TWOQ_A1IN].tail;
+        retire_to_ghost(repl, frame, TWOQ_A1OUT);
+    } else {
+        frame = lists[TWOQ_AM].tail;
+        list_remove(repl, &lists[TWOQ_AM], 0, frame);
+    }
+    return frame;
+}
+
+static int twoq_miss(Repl *repl, uint64_t page) {
+
+    int g = ghost_find(repl, page);
+    if (g >= 0) {
+        repl->ghost_hits++;
+        drop_ghost(repl, g);
+    }
+
+    int frame = twoq_reclaim(repl);
+    admit(repl, frame, page, g >= 0 ? TWOQ_AM : TWOQ_A1IN);
+    return frame;
+}
+
+static void twoq_hit(Repl *repl, int frame) {
+    if (repl->nodes[frame].list == TWOQ_AM) {
+        list_remove(repl, &repl->lists[TWOQ_AM], 0, frame);
+        list_push_head(repl, &repl->lists[TWOQ_AM], 0, frame);
+    }
+}
+
+// LIRS (Jiang e Zhang): as páginas LIR (distância de reuso curta) ocupam quase toda a memória e
+// só as HIR residentes (fila Q, 1% da memória) são despejadas. A pilha S guarda a recência das
+// LIR e das HIR recentes, inclusive das já despejadas (fantasmas): uma HIR acessada de novo
+// enquanto está em S tem reuso mais curto que a LIR mais antiga e troca de lugar com ela.
+// Os fantasmas em S são limitados ao número de quadros, descartando o mais antigo
+
+// Tira do fundo de S as páginas que não são LIR, para o fundo ser sempre a LIR mais antiga
+static void lirs_prune(Repl *repl) {
+    ReplList *stack = &repl->lists[LIRS_S];
+    while (stack->size > 0) {
+        int n = stack->tail;
+        ReplNode *node = &repl->nodes[n];
+        if (node->flags & LIRS_LIR) {
+            break;
+        }
+        list_remove(repl, stack, 0, n);
+        node->flags &= ~LIRS_IN_S;
+        if (node->flags & LIRS_GHOST) {
+            list_remove(repl, &repl->lists[LIRS_GHOSTS], 1, n);
+            ghost_release(repl, n);
+        }
+    }
+}
+
+// A LIR mais antiga vira HIR residente no fim de Q
+static void lirs_demote_bottom(Repl *repl) {
+    lirs_prune(repl);
+    ReplList *stack = &repl->lists[LIRS_S];
+    if (stack->size == 0) {
+        return;
+    }
+    int n = stack->tail;
+    list_remove(repl, stack, 0, n);
+    repl->nodes[n].flags = LIRS_IN_Q;
+    list_push_tail(repl, &repl->lists[LIRS_Q], 1, n);
+    repl->lir_count--;
+    lirs_prune(repl);
+}
+
+static void lirs_make_lir(Repl *repl, int n) {
+    repl->nodes[n].flags = LIRS_LIR | LIRS_IN_S;
+    repl->lir_count++;
+    if (repl->lir_count > repl->in_limit) {
+        lirs_demote_bottom(repl);
+    }
+}
+
+static void lirs_hit(Repl *repl, int frame) {
+
+    ReplNode *node = &repl->nodes[frame];
+    ReplList *stack = &repl->lists[LIRS_S];
+
+    if (node->flags & LIRS_LIR) {
+        int was_bottom = stack->tail == frame;
+        list_remove(repl, stack, 0, frame);
+        list_push_head(repl, stack, 0, frame);
+        if (was_bottom) {
+            lirs_prune(repl);
+        }
+    } else if (node->flags & LIRS_IN_S) {
+        list_remove(repl, stack, 0, frame);
+        list_push_head(repl, stack, 0, frame);
+        list_remove(repl, &repl->lists[LIRS_Q], 1, frame);
+        lirs_make_lir(repl, frame);
+    } else {
+        list_push_head(repl, stack, 0, frame);
+        node->flags |= LIRS_IN_S;
+        list_remove(repl, &repl->lists[LIRS_Q], 1, frame);
+        list_push_tail(repl, &repl->lists[LIRS_Q], 1, frame);
+    }
+}
+
+// Despeja a HIR residente do início de Q; se ela ainda está em S, vira fantasma no mesmo lugar
+static int lirs_evict(Repl *repl) {
+
+    int frame = take_free_frame(repl);
+    if (frame >= 0) {
+        return frame;
+    }
+
+    ReplList *stack = &repl->lists[LIRS_S];
+    ReplList *ghosts = &repl->lists[LIRS_GHOSTS];
+
+    if (repl->lists[LIRS_Q].size == 0) {
+        // Só há LIR (memórias de um quadro): despeja a mais antiga
+        lirs_prune(repl);
+        frame = stack->tail;
+        list_remove(repl, stack, 0, frame);
+        repl->lir_count--;
+        repl->nodes[frame].flags = 0;
+        lirs_prune(repl);
+        return frame;
+    }
+
+    frame = repl->lists[LIRS_Q].head;
+    list_remove(repl, &repl->lists[LIRS_Q], 1, frame);
+
+    if (repl->nodes[frame].flags & LIRS_IN_S) {
+        int g = ghost_alloc(repl, repl->nodes[frame].page);
+        list_replace(repl, stack, 0, frame, g);
+        repl->nodes[g].flags = LIRS_IN_S | LIRS_GHOST;
+        list_push_tail(repl, ghosts, 1, g);
+
+        // O nó a mais do conjunto de fantasmas cobre o novo até o mais antigo sair
+        if (ghosts->size > repl->capacity) {
+            int oldest = ghosts->head;
+            list_remove(repl, stack, 0, oldest);
+            list_remove(repl, ghosts, 1, oldest);
+            ghost_release(repl, oldest);
+            lirs_prune(repl);
+        }
+    }
+
+    repl->nodes[frame].flags = 0;
+    return frame;
+}
+
+static int lirs_miss(Repl *repl, uint64_t page) {
+
+    ReplList *stack = &repl->lists[LIRS_S];
+
+    // Um fantasma em S sai antes do despejo, que pode precisar do lugar dele
+    int g = ghost_find(repl, page);
+    if (g >= 0) {
+        repl->ghost_hits++;
+        list_remove(repl, stack, 0, g);
+        list_remove(repl, &repl->lists[LIRS_GHOSTS], 1, g);
+        ghost_release(repl, g);
+    }
+
+    int frame = lirs_evict(repl);
+    repl->nodes[frame].page = page;
+    list_push_head(repl, stack, 0, frame);
+
+    if (g >= 0 || repl->lir_count < repl->in_limit) {
+        lirs_make_lir(repl, frame);
+    } else {
+        repl->nodes[frame].flags = LIRS_IN_S | LIRS_IN_Q;
+        list_push_tail(repl, &repl->lists[LIRS_Q], 1, frame);
+    }
+    return frame;
+}
+
+// CLOCK-Pro (Jiang, Chen e Zhang): a aproximação do LIRS por relógio. Páginas quentes, frias e
+// frias já despejadas (em teste, os fantasmas) ficam num único relógio com três mãos: a fria
+// despeja as frias sem referência (que ficam em teste) e promove as referenciadas, a quente
+// esfria as quentes sem referência e a de teste descarta os fantasmas. Um acerto só liga o bit
+// de referência. Um fantasma que volta aumenta o alvo de páginas frias e um descartado o diminui.
+// As páginas em teste são limitadas ao número de quadros. A mão de teste não empurra a mão fria,
+// então cada falta despeja exatamente uma página
+
+#define RING_PREV(repl, n) ((repl)->nodes[n].link[0].prev)
+#define RING_NEXT(repl, n) ((repl)->nodes[n].link[0].next)
+
+static void ring_insert_before(Repl *repl, int n, int at) {
+    int prev = RING_PREV(repl, at);
+    RING_PREV(repl, n) = prev;
+    RING_NEXT(repl, n) = at;
+    RING_NEXT(repl, prev) = n;
+    RING_PREV(repl, at) = n;
+}
+
+static void ring_delete(Repl *repl, int n) {
+    int prev = RING_PREV(repl, n);
+    int next = RING_NEXT(repl, n);
+    if (repl->hand_hot == n) repl->hand_hot = prev;
+    if (repl->hand_cold == n) repl->hand_cold = prev;
+    if (repl->hand_test == n) repl->hand_test = prev;
+    RING_NEXT(repl, prev) = next;
+    RING_PREV(repl, next) = prev;
+}
+
+static void ring_replace(Repl *repl, int old, int new) {
+    int prev = RING_PREV(repl, old);
+    int next = RING_NEXT(repl, old);
+    RING_PREV(repl, new) = prev;
+    RING_NEXT(repl, new) = next;
+    RING_NEXT(repl, prev) = new;
+    RING_PREV(repl, next) = new;
+    if (repl->hand_hot == old) repl->hand_hot = new;
+    if (repl->hand_cold == old) repl->hand_cold = new;
+    if (repl->hand_test == old) repl->hand_test = new;
+}
+
+static void clockpro_run_hand_test(Repl *repl) {
+    int n = repl->hand_test;
+    if (repl->nodes[n].flags & CLOCKPRO_TEST) {
+        ring_delete(repl, n);
+        ghost_release(repl, n);
+        repl->test_count--;
+        if (repl->target > 1) {
+            repl->target--;
+        }
+    }
+    repl->hand_test = RING_NEXT(repl, repl->hand_test);
+}
+
+static void clockpro_run_hand_hot(Repl *repl) {
+    if (repl->hand_hot == repl->hand_test) {
+        clockpro_run_hand_test(repl);
+    }
+    PROF_COUNT(PROF_SKIPPED_FRAMES, 1);
+    ReplNode *node = &repl->nodes[repl->hand_hot];
+    if (node->flags & CLOCKPRO_HOT) {
+        if (node->flags & CLOCKPRO_REF) {
+            node->flags &= ~CLOCKPRO_REF;
+        } else {
+            node->flags = CLOCKPRO_COLD;
+            repl->hot_count--;
+            repl->cold_count++;
+        }
+    }
+    repl->hand_hot = RING_NEXT(repl, repl->hand_hot);
+}
+
+static void clockpro_run_hand_cold(Repl *repl) {
+    int n = repl->hand_cold;
+    ReplNode *node = &repl->nodes[n];
+    // Só a fria sem referência é despejada; as outras o ponteiro pula
+    if ((node->flags & (CLOCKPRO_COLD | CLOCKPRO_REF)) != CLOCKPRO_COLD) {
+        PROF_COUNT(PROF_SKIPPED_FRAMES, 1);
+    }
+    if (node->flags & CLOCKPRO_COLD) {
+        if (node->flags & CLOCKPRO_REF) {
+            node->flags = CLOCKPRO_HOT;
+            repl->cold_count--;
+            repl->hot_count++;
+        } else {
+            int g = ghost_alloc(repl, node->page);
+            repl->nodes[g].flags = CLOCKPRO_TEST;
+            ring_replace(repl, n, g);
+            node->flags = 0;
+            repl->cold_count--;
+            repl->test_count++;
+            repl->evicted_frame = n;
+            while (repl->test_count > repl->capacity) {
+                clockpro_run_hand_test(repl);
+            }
+        }
+    }
+    repl->hand_cold = RING_NEXT(repl, repl->hand_cold);
+    while (repl->capacity - repl->target < repl->hot_count) {
+        clockpro_run_hand_hot(repl);
+    }
+}
+
+static int clockpro_miss(Repl *repl, uint64_t page) {
+
+    int hot = 0;
+    int g = ghost_find(repl, page);
+    if (g >= 0) {
+        repl->ghost_hits++;
+        if (repl->target < repl->capacity) {
+            repl->target++;
+        }
+        ring_delete(repl, g);
+        ghost_release(repl, g);
+        repl->test_count--;
+        hot = 1;
+    }
+
+    int frame = take_free_frame(repl);
+    if (frame < 0) {
+        repl->evicted_frame = -1;
+        while (repl->evicted_frame < 0) {
+            clockpro_run_hand_cold(repl);
+        }
+        frame = repl->evicted_frame;
+    }
+
+    ReplNode *node = &repl->nodes[frame];
+    node->page = page;
+    node->flags = hot ? CLOCKPRO_HOT : CLOCKPRO_COLD;
+    if (hot) {
+        repl->hot_count++;
+    } else {
+        repl->cold_count++;
+    }
+
+    if (repl->hand_hot < 0) {
+        RING_PREV(repl, frame) = frame;
+        RING_NEXT(repl, frame) = frame;
+        repl->hand_hot = repl->hand_cold = repl->hand_test = frame;
+    } else {
+        ring_insert_before(repl, frame, repl->hand_hot);
+        if (repl->hand_cold == repl->hand_hot) {
+            repl->hand_cold = frame;
+        }
+    }
+    return frame;
+}
+
+void repl_init(Repl *repl, int kind, unsigned capacity) {
+
+    memset(repl, 0, sizeof(*repl));
+    repl->kind = kind;
+    repl->capacity = capacity;
+
+    // Um nó por quadro e até capacity + 1 fantasmas
+    repl->num_nodes = 2 * capacity + 1;
+    unsigned buckets = 1;
+    while (buckets < 2 * (capacity + 1)) {
+        buckets *= 2;
+    }
+    repl->bucket_mask = buckets - 1;
+
+    repl->nodes = (ReplNode *)calloc(repl->num_nodes, sizeof(ReplNode));
+    repl->buckets = (int *)malloc(buckets * sizeof(int));
+    if (!repl->nodes || !repl->buckets) {
+        fprintf(stderr, "Erro ao alocar memória para a política %s\n", repl_kind_name(kind));
+        exit(EXIT_FAILURE);
+    }
+    for (unsigned i = 0; i < buckets; i++) {
+        repl->buckets[i] = -1;
+    }
+
+    repl->free_ghosts = -1;
+    for (unsigned n = repl->num_nodes; n-- > capacity;) {
+        repl->nodes[n].link[0].next = repl->free_ghosts;
+        repl->free_ghosts = (int)n;
+    }
+
+    for (int i = 0; i < REPL_MAX_LISTS; i++) {
+        list_init(&repl->lists[i]);
+    }
+
+    switch (kind) {
+    case REPL_2Q:
+        repl->in_limit = capacity / 4 > 0 ? capacity / 4 : 1;
+        repl->out_limit = capacity / 2 > 0 ? capacity / 2 : 1;
+        break;
+    case REPL_LIRS: {
+        unsigned hir = capacity / 100 > 0 ? capacity / 100 : 1;
+        repl->in_limit = capacity > hir ? capacity - hir : 0;
+        break;
+    }
+    case REPL_CLOCKPRO:
+        repl->target = capacity;
+        repl->hand_hot = repl->hand_cold = repl->hand_test = -1;
+        break;
+    }
+}
+
+void repl_free(Repl *repl) {
+    free(repl->nodes);
+    free(repl->buckets);
+    repl->nodes = NULL;
+    repl->buckets = NULL;
+}
+
+void repl_hit(Repl *repl, int frame) {
+    switch (repl->kind) {
+    case REPL_ARC:
+        arc_hit(repl, frame);
+        break;
+    case REPL_2Q:
+        twoq_hit(repl, frame);
+        break;
+    case REPL_LIRS:
+        lirs_hit(repl, frame);
+        break;
+    case REPL_CLOCKPRO:
+        repl->nodes[frame].flags |= CLOCKPRO_REF;
+        break;
+    }
+}
+
+int repl_miss(Repl *repl, uint64_t page) {
+    repl->misses++;
+    switch (repl->kind) {
+    case REPL_ARC:
+        return arc_miss(repl, page);
+    case REPL_2Q:
+        return twoq_miss(repl, page);
+    case REPL_LIRS:
+        return lirs_miss(repl, page);
+    default:
+        return clockpro_miss(repl, page);
+    }
+}
+
+void repl_print_stats(const Repl *repl) {
+
+    printf("Faltas que acertaram fantasmas: %lu de %lu (%.2f%%)\n", repl->ghost_hits, repl->misses,
+           repl->misses ? 100.0 * repl->ghost_hits / repl->misses : 0.0);
+
+    switch (repl->kind) {
+    case REPL_ARC:
+        printf("Acertos em B1 (recencia): %lu, em B2 (frequencia): %lu; alvo final de T1: %u de %u quadros\n",
+               repl->list_ghost_hits[0], repl->list_ghost_hits[1], repl->target, repl->capacity);
+        break;
+    case REPL_2Q:
+        printf("Filas do 2Q: A1in ate %u paginas, A1out ate %u fantasmas\n", repl->in_limit, repl->out_limit);
+        break;
+    case REPL_LIRS:
+        printf("Paginas LIR: %u de %u quadros; fantasmas HIR na pilha: %u\n",
+               repl->lir_count, repl->capacity, repl->lists[LIRS_GHOSTS].size);
+        break;
+    case REPL_CLOCKPRO:
+        printf("Paginas quentes: %u, frias: %u, em teste: %u; alvo final de frias: %u\n",
+               repl->hot_count, repl->cold_count, repl->test_count, repl->target);
+        break;
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef REPL_H
+#define REPL_H
+
+#include <stdint.h>
+
+// Políticas de substituição resistentes a varreduras (ARC, 2Q, LIRS e CLOCK-Pro), compartilhadas
+// pelas quatro tabelas. O simulador avisa os acertos pelo quadro (repl_hit) e, numa falta, pede o
+// quadro onde carregar a página (repl_miss); se o quadro devolvido estiver ocupado, o simulador
+// despeja a página que está nele, como faria com a vítima de qualquer outra política.
+//
+// Todas guardam "fantasmas": o número de páginas despejadas há pouco, sem os dados, para notar
+// quando uma delas volta. Os fantasmas vivem num conjunto fixo de nós (um por quadro, mais um)
+// achados por uma tabela hash, então a memória é limitada e cada operação é O(1) amortizado
+
+enum { REPL_ARC, REPL_2Q, REPL_LIRS, REPL_CLOCKPRO, NUM_REPL_KINDS };
+
+typedef struct {
+    int prev;
+    int next;
+} ReplLink;
+
+// Nó de uma página. Os nós 0..capacity-1 são os quadros (a página residente em cada um) e os
+// seguintes são os fantasmas. link[0] é a lista principal da política; link[1] é a segunda
+// lista do LIRS (fila Q dos HIR residentes, ou ordem de idade dos HIR não residentes)
+typedef struct {
+    uint64_t page;
+    int hash_next;      // próximo fantasma na cadeia da tabela hash
+    uint8_t list;       // lista de link[0] em que o nó está
+    uint8_t flags;
+    ReplLink link[2];
+} ReplNode;
+
+// Lista duplamente encadeada por índices; head é o lado mais recente
+typedef struct {
+    int head;
+    int tail;
+    unsigned size;
+} ReplList;
+
+#define REPL_MAX_LISTS 4
+
+typedef struct {
+    int kind;
+    unsigned capacity;          // quadros
+    unsigned next_free;         // quadros ainda não usados, entregues em ordem
+
+    ReplNode *nodes;
+    unsigned num_nodes;
+    int free_ghosts;            // nós fantasmas livres, encadeados por link[0].next
+    int *buckets;               // tabela hash página -> fantasma
+    unsigned bucket_mask;
+
+    ReplList lists[REPL_MAX_LISTS];
+
+    unsigned target;            // ARC: alvo p de T1. CLOCK-Pro: alvo de páginas frias
+    unsigned in_limit;          // 2Q: Kin. LIRS: máximo de páginas LIR
+    unsigned out_limit;         // 2Q: Kout
+    unsigned lir_count;         // LIRS
+
+    // CLOCK-Pro: as três mãos sobre o relógio (lists[0].head é só um ponto de entrada)
+    int hand_hot, hand_cold, hand_test;
+    unsigned hot_count, cold_count, test_count;
+    int evicted_frame;
+
+    unsigned long misses;
+    unsigned long ghost_hits;
+    unsigned long list_ghost_hits[2];   // ARC: B1 e B2
+} Repl;
+
+void repl_init(Repl *repl, int kind, unsigned capacity);
+
+// Libera os nós; os contadores continuam valendo para o relatório
+void repl_free(Repl *repl);
+
+// Acerto na página do quadro
+void repl_hit(Repl *repl, int frame);
+
+// count acertos seguidos no mesmo quadro. Depois de dois acertos seguidos qualquer uma das
+// políticas chega a um ponto fixo (a página no topo da lista mais protegida), então os demais
+// não mudam nada
+static inline void repl_hits(Repl *repl, int frame, unsigned long count) {
+    for (unsigned long i = 0; i < count && i < 2; i++) {
+        repl_hit(repl, frame);
+    }
+}
+
+// Falta da página: devolve o quadro onde ela deve ser carregada (livre ou com a vítima)
+int repl_miss(Repl *repl, uint64_t page);
+
+const char *repl_kind_name(int kind);
+
+// Faltas que acertaram um fantasma, e em qual lista
+void repl_print_stats(const Repl *repl);
+
+#endif
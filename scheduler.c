@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "scheduler.h"
+
+// Fila de uma thread: a dona consome do início e as outras roubam do fim
+typedef struct {
+    pthread_mutex_t lock;
+    int *jobs;
+    int head;
+    int tail;
+} WorkQueue;
+
+typedef struct {
+    Scheduler *scheduler;
+    int id;
+} Worker;
+
+struct Scheduler {
+    int num_threads;
+    int num_jobs;
+    JobFn run;
+    void *arg;
+
+    WorkQueue *queues;
+    Worker *workers;
+    pthread_t *threads;
+
+    // Conclusão dos jobs, para quem consome os resultados em ordem
+    pthread_mutex_t done_lock;
+    pthread_cond_t done_cond;
+    char *done;
+};
+
+static int queue_pop_head(WorkQueue *queue) {
+    int job = -1;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->head < queue->tail) {
+        job = queue->jobs[queue->head++];
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return job;
+}
+
+static int queue_steal_tail(WorkQueue *queue) {
+    int job = -1;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->head < queue->tail) {
+        job = queue->jobs[--queue->tail];
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return job;
+}
+
+// Próximo job da thread: primeiro a própria fila, depois as das outras em sequência.
+// Nenhum job novo é criado durante a execução, então filas vazias significam fim
+static int next_job(Scheduler *scheduler, int id) {
+
+    int job = queue_pop_head(&scheduler->queues[id]);
+    if (job >= 0) {
+        return job;
+    }
+
+    for (int i = 1; i < scheduler->num_threads; i++) {
+        job = queue_steal_tail(&scheduler->queues[(id + i) % scheduler->num_threads]);
+        if (job >= 0) {
+            return job;
+        }
+    }
+    return -1;
+}
+
+static void *worker_main(void *data) {
+
+    Worker *worker = (Worker *)data;
+    Scheduler *scheduler = worker->scheduler;
+
+    int job;
+    while ((job = next_job(scheduler, worker->id)) >= 0) {
+        scheduler->run(scheduler->arg, job);
+
+        pthread_mutex_lock(&scheduler->done_lock);
+        scheduler->done[job] = 1;
+        pthread_cond_broadcast(&scheduler->done_cond);
+        pthread_mutex_unlock(&scheduler->done_lock);
+    }
+    return NULL;
+}
+
+// Ordem dos jobs por custo decrescente (estável pelo índice)
+static const double *sort_costs;
+
+static int compare_cost(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    if (sort_costs[x] != sort_costs[y]) {
+        return sort_costs[x] < sort_costs[y] ? 1 : -1;
+    }
+    return x - y;
+}
+
+Scheduler *scheduler_start(int num_threads, int num_jobs, const double *costs, JobFn run, void *arg) {
+
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+    if (num_threads > num_jobs && num_jobs > 0) {
+        num_threads = num_jobs;
+    }
+
+    Scheduler *scheduler = (Scheduler *)calloc(1, sizeof(Scheduler));
+    int *order = (int *)malloc((num_jobs + 1) * sizeof(int));
+    if (!scheduler || !order) {
+        fprintf(stderr, "Erro ao alocar memória para o escalonador\n");
+        exit(EXIT_FAILURE);
+    }
+
+    scheduler->num_threads = num_threads;
+    scheduler->num_jobs = num_jobs;
+    scheduler->run = run;
+    scheduler->arg = arg;
+    scheduler->queues = (WorkQueue *)calloc(num_threads, sizeof(WorkQueue));
+    scheduler->workers = (Worker *)calloc(num_threads, sizeof(Worker));
+    scheduler->threads = (pthread_t *)calloc(num_threads, sizeof(pthread_t));
+    scheduler->done = (char *)calloc(num_jobs + 1, 1);
+    if (!scheduler->queues || !scheduler->workers || !scheduler->threads || !scheduler->done) {
+        fprintf(stderr, "Erro ao alocar memória para o escalonador\n");
+        exit(EXIT_FAILURE);
+    }
+    pthread_mutex_init(&scheduler->done_lock, NULL);
+    pthread_cond_init(&scheduler->done_cond, NULL);
+
+    for (int i = 0; i < num_jobs; i++) {
+        order[i] = i;
+    }
+    if (costs) {
+        sort_costs = costs;
+        qsort(order, num_jobs, sizeof(int), compare_cost);
+    }
+
+    // Distribui em rodízio: cada fila começa pelos jobs mais caros
+    for (int t = 0; t < num_threads; t++) {
+        WorkQueue *queue = &scheduler->queues[t];
+        pthread_mutex_init(&queue->lock, NULL);
+        queue->jobs = (int *)malloc((num_jobs / num_threads + 1) * sizeof(int));
+        if (!queue->jobs) {
+            fprintf(stderr, "Erro ao alocar memória para o escalonador\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int i = 0; i < num_jobs; i++) {
+        WorkQueue *queue = &scheduler->queues[i % num_threads];
+        queue->jobs[queue->tail++] = order[i];
+    }
+    free(order);
+
+    for (int t = 0; t < num_threads; t++) {
+        scheduler->workers[t].scheduler = scheduler;
+        scheduler->workers[t].id = t;
+        if (pthread_create(&scheduler->threads[t], NULL, worker_main, &scheduler->workers[t]) != 0) {
+            fprintf(stderr, "Erro ao criar thread do escalonador\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    return scheduler;
+}
+
+void scheduler_wait_job(Scheduler *scheduler, int job) {
+    pthread_mutex_lock(&scheduler->done_lock);
+    while (!scheduler->done[job]) {
+        pthread_cond_wait(&scheduler->done_cond, &scheduler->done_lock);
+    }
+    pthread_mutex_unlock(&scheduler->done_lock);
+}
+
+void scheduler_finish(Scheduler *scheduler) {
+
+    for (int t = 0; t < scheduler->num_threads; t++) {
+        pthread_join(scheduler->threads[t], NULL);
+        pthread_mutex_destroy(&scheduler->queues[t].lock);
+        free(scheduler->queues[t].jobs);
+    }
+
+    pthread_mutex_destroy(&scheduler->done_lock);
+    pthread_cond_destroy(&scheduler->done_cond);
+    free(scheduler->queues);
+    free(scheduler->workers);
+    free(scheduler->threads);
+    free(scheduler->done);
+    free(scheduler);
+}
+
+int scheduler_default_threads() {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
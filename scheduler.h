@@ -0,0 +1,26 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+// Escalonador de jobs independentes num pool de threads com roubo de trabalho.
+// Cada thread tem sua fila; quando a própria fila esvazia, ela rouba do fim da fila
+// de outra thread, então traces longos não deixam núcleos ociosos no final do sweep.
+
+typedef void (*JobFn)(void *arg, int job);
+
+typedef struct Scheduler Scheduler;
+
+// Inicia num_threads threads que executam run(arg, job) para job = 0..num_jobs-1.
+// costs (opcional) é o custo estimado de cada job: os mais caros são distribuídos e
+// executados primeiro
+Scheduler *scheduler_start(int num_threads, int num_jobs, const double *costs, JobFn run, void *arg);
+
+// Bloqueia até o job terminar; permite consumir os resultados na ordem dos jobs
+void scheduler_wait_job(Scheduler *scheduler, int job);
+
+// Espera todas as threads terminarem e libera o escalonador
+void scheduler_finish(Scheduler *scheduler);
+
+// Número de processadores disponíveis
+int scheduler_default_threads();
+
+#endif
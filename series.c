@@ -0,0 +1,231 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "series.h"
+
+// Espera da thread gravadora quando o anel está vazio
+#define SERIES_IDLE_NS 1000000
+
+int series_parse_spec(const char *spec, unsigned long *window, int *format, const char **path) {
+
+    char *end;
+    *window = strtoul(spec, &end, 10);
+    *format = SERIES_CSV;
+    *path = NULL;
+    if (end == spec || *window == 0 || *window == ULONG_MAX) {
+        fprintf(stderr, "Série inválida: %s (use janela[/csv|/bin][:arquivo], com a janela em acessos, por exemplo 100000)\n", spec);
+        return -1;
+    }
+    if (*end == '/') {
+        const char *name = end + 1;
+        size_t length = strcspn(name, ":");
+        if (length == 3 && strncmp(name, "csv", 3) == 0) {
+            *format = SERIES_CSV;
+        } else if (length == 3 && strncmp(name, "bin", 3) == 0) {
+            *format = SERIES_BINARY;
+        } else {
+            fprintf(stderr, "Série inválida: %s (o formato é csv ou bin)\n", spec);
+            return -1;
+        }
+        end = (char *)name + length;
+    }
+    if (*end == ':') {
+        if (end[1] == '\0') {
+            fprintf(stderr, "Série inválida: %s (arquivo vazio)\n", spec);
+            return -1;
+        }
+        *path = end + 1;
+    } else if (*end != '\0') {
+        fprintf(stderr, "Série inválida: %s (use janela[/csv|/bin][:arquivo])\n", spec);
+        return -1;
+    }
+    if (*format == SERIES_BINARY && !*path) {
+        fprintf(stderr, "Série inválida: %s (a série binária precisa de um arquivo)\n", spec);
+        return -1;
+    }
+    return 0;
+}
+
+static void write_varint(FILE *out, uint64_t value) {
+    while (value >= 0x80) {
+        fputc((int)(value & 0x7f) | 0x80, out);
+        value >>= 7;
+    }
+    fputc((int)value, out);
+}
+
+static double estimate(const Series *series, uint64_t count) {
+    return count / series->rate;
+}
+
+// Grava a janela que termina em sample, a partir da anterior
+static void write_window(Series *series, const SeriesSample *sample) {
+
+    const SeriesSample *last = &series->last;
+    uint64_t accesses = sample->accesses - last->accesses;
+    uint64_t faults = sample->faults - last->faults;
+    uint64_t writes = sample->writes - last->writes;
+
+    if (series->format == SERIES_BINARY) {
+        write_varint(series->out, sample->end - last->end);
+        write_varint(series->out, accesses);
+        write_varint(series->out, faults);
+        write_varint(series->out, writes);
+        write_varint(series->out, sample->dirty);
+    } else {
+        // Sem acessos simulados (toda a janela fora da amostra) não há taxa de acertos
+        fprintf(series->out, "%lu,%llu,%llu,%.0f,%.0f,", series->windows,
+                (unsigned long long)last->end, (unsigned long long)sample->end,
+                estimate(series, faults), estimate(series, writes));
+        if (accesses) {
+            fprintf(series->out, "%.6f", 1.0 - (double)faults / accesses);
+        }
+        fprintf(series->out, ",%.0f\n", estimate(series, sample->dirty));
+    }
+    series->last = *sample;
+    series->windows++;
+}
+
+// Thread gravadora: esvazia o anel até o produtor fechá-lo e só dorme quando o encontra vazio.
+// closed é lido antes do anel, então um anel vazio depois do fechamento já não vai receber nada.
+// Depois de um erro de gravação as amostras só são consumidas, para o produtor não parar
+static void *series_main(void *arg) {
+
+    Series *series = (Series *)arg;
+    for (;;) {
+        int closed = atomic_load_explicit(&series->closed, memory_order_acquire);
+        unsigned long head = atomic_load_explicit(&series->head, memory_order_relaxed);
+        unsigned long tail = atomic_load_explicit(&series->tail, memory_order_acquire);
+        if (head != tail) {
+            for (; head != tail; head++) {
+                if (!series->failed) {
+                    write_window(series, &series->ring[head & (SERIES_RING_SLOTS - 1)]);
+                }
+                atomic_store_explicit(&series->head, head + 1, memory_order_release);
+            }
+            continue;
+        }
+        if (closed) {
+            break;
+        }
+        if (!series->failed && (fflush(series->out) != 0 || ferror(series->out))) {
+            series->failed = 1;
+        }
+        struct timespec idle = {0, SERIES_IDLE_NS};
+        nanosleep(&idle, NULL);
+    }
+    return NULL;
+}
+
+int series_start(Series *series, unsigned long window, int format, const char *path, double rate) {
+
+    memset(series, 0, sizeof(*series));
+    series->next = ULONG_MAX;
+    if (window == 0) {
+        return 0;
+    }
+
+    series->window = window;
+    series->next = window;
+    series->format = format;
+    series->rate = rate > 0 ? rate : 1.0;
+    series->out = stdout;
+    if (path) {
+        series->out = fopen(path, format == SERIES_BINARY ? "wb" : "w");
+        if (!series->out) {
+            perror("Erro ao criar o arquivo da série");
+            return -1;
+        }
+        series->close_out = 1;
+    }
+
+    series->ring = (SeriesSample *)malloc(SERIES_RING_SLOTS * sizeof(SeriesSample));
+    if (!series->ring) {
+        fprintf(stderr, "Erro ao alocar o anel da série\n");
+        if (series->close_out) {
+            fclose(series->out);
+        }
+        return -1;
+    }
+
+    if (format == SERIES_BINARY) {
+        uint16_t version = SERIES_VERSION, reserved = 0;
+        uint64_t window_field = window;
+        fwrite(SERIES_MAGIC, 1, 4, series->out);
+        fwrite(&version, sizeof(version), 1, series->out);
+        fwrite(&reserved, sizeof(reserved), 1, series->out);
+        fwrite(&window_field, sizeof(window_field), 1, series->out);
+        fwrite(&series->rate, sizeof(series->rate), 1, series->out);
+    } else {
+        fprintf(series->out, "janela,inicio,fim,paginas_lidas,paginas_escritas,taxa_acertos,sujas_residentes\n");
+    }
+
+    if (pthread_create(&series->thread, NULL, series_main, series) != 0) {
+        fprintf(stderr, "Erro ao criar a thread da série\n");
+        free(series->ring);
+        if (series->close_out) {
+            fclose(series->out);
+        }
+        return -1;
+    }
+    return 0;
+}
+
+// Põe a amostra no anel; devolve 0 se ele estava cheio
+static int push_sample(Series *series, const SeriesSample *sample) {
+    unsigned long tail = atomic_load_explicit(&series->tail, memory_order_relaxed);
+    unsigned long head = atomic_load_explicit(&series->head, memory_order_acquire);
+    if (tail - head == SERIES_RING_SLOTS) {
+        return 0;
+    }
+    series->ring[tail & (SERIES_RING_SLOTS - 1)] = *sample;
+    atomic_store_explicit(&series->tail, tail + 1, memory_order_release);
+    series->recorded = sample->end;
+    return 1;
+}
+
+void series_record(Series *series, const SeriesSample *sample) {
+    if (!push_sample(series, sample)) {
+        series->dropped++;
+    }
+    // Depois de uma sequência longa ou de acessos fora da amostra, a próxima janela que ainda não acabou
+    series->next = (sample->end / series->window + 1) * series->window;
+}
+
+int series_finish(Series *series, const SeriesSample *sample) {
+
+    if (!series->window) {
+        return 0;
+    }
+
+    // Com a simulação acabada já não há laço para não atrasar: espera vaga para a última janela,
+    // que também leva os acessos de uma amostra descartada logo antes
+    if (sample->end > series->recorded) {
+        while (!push_sample(series, sample)) {
+            struct timespec idle = {0, SERIES_IDLE_NS};
+            nanosleep(&idle, NULL);
+        }
+    }
+    atomic_store_explicit(&series->closed, 1, memory_order_release);
+    pthread_join(series->thread, NULL);
+    free(series->ring);
+    series->ring = NULL;
+    series->next = ULONG_MAX;
+
+    if (series->dropped) {
+        fprintf(stderr, "Série: %lu janelas juntadas às seguintes com o anel cheio\n", series->dropped);
+    }
+    // failed só é escrito pela thread, que já terminou
+    int status = series->failed || ferror(series->out) ? -1 : 0;
+    if (series->close_out) {
+        status = fclose(series->out) != 0 ? -1 : status;
+    } else {
+        fflush(series->out);
+    }
+    if (status != 0) {
+        fprintf(stderr, "Erro ao gravar a série\n");
+    }
+    return status;
+}
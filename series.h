@@ -0,0 +1,92 @@
+#ifndef SERIES_H
+#define SERIES_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+// Série temporal por janelas de acessos, compartilhada pelas tabelas. A cada window acessos
+// do trace o laço de acessos anota os contadores acumulados (faltas, escritas e sujas residentes)
+// num anel sem trava de um produtor e um consumidor; uma thread gravadora esvazia o anel e grava
+// cada janela, então o laço nunca espera pela saída. Como as amostras são acumuladas, quando o
+// anel está cheio a amostra é descartada e a janela só se junta à seguinte: nada se perde, a
+// gravação só fica menos fina. Numa simulação amostrada (shards.h) as janelas contam os acessos do
+// trace inteiro e as contagens saem estimadas, divididas pela taxa.
+//
+// Formato CSV: janela,inicio,fim,paginas_lidas,paginas_escritas,taxa_acertos,sujas_residentes,
+// com inicio e fim em acessos do trace (a janela é [inicio, fim)) e a taxa de acertos da tabela.
+//
+// Formato binário (.bin), compacto: cabeçalho de 24 bytes (little-endian)
+//   magic[4]   "VMWS"
+//   version    uint16
+//   reserved   uint16
+//   window     uint64 (acessos por janela pedidos)
+//   rate       double (taxa da amostragem; 1 sem amostragem)
+// seguido de um registro por janela com cinco inteiros sem sinal em LEB128 (7 bits por byte, o
+// bit alto marca que há mais bytes): acessos do trace na janela, acessos simulados, faltas,
+// escritas e sujas residentes no fim dela, todos da amostra. A janela i termina na soma dos
+// primeiros i + 1 campos de acessos do trace
+
+#define SERIES_MAGIC "VMWS"
+#define SERIES_VERSION 1
+
+// Amostras no anel (potência de 2)
+#define SERIES_RING_SLOTS 4096
+
+enum { SERIES_CSV, SERIES_BINARY };
+
+typedef struct {
+    uint64_t end;           // acessos do trace até aqui, incluindo os que ficaram fora da amostra
+    uint64_t accesses;      // acessos simulados até aqui
+    uint64_t faults;
+    uint64_t writes;
+    uint64_t dirty;         // páginas sujas residentes agora
+} SeriesSample;
+
+typedef struct {
+    unsigned long window;           // 0 = série desligada
+    unsigned long next;             // fim da janela atual; ULONG_MAX com a série desligada
+    int format;
+    double rate;
+    FILE *out;
+    int close_out;                  // out foi aberto pela série
+    pthread_t thread;
+    unsigned long recorded;         // fim da última amostra posta no anel
+    unsigned long dropped;          // amostras descartadas com o anel cheio
+
+    SeriesSample *ring;
+    // O produtor só escreve tail e o consumidor só escreve head, em linhas de cache separadas
+    _Alignas(64) atomic_ulong head;
+    _Alignas(64) atomic_ulong tail;
+    atomic_int closed;
+
+    // Estado da thread gravadora
+    SeriesSample last;
+    unsigned long windows;
+    int failed;                     // erro de gravação; as janelas seguintes são descartadas
+} Series;
+
+// Lê "janela[/csv|/bin][:arquivo]" (ex.: 100000 ou 100000/bin:janelas.bin). Sem arquivo a série
+// CSV vai para a saída padrão, antes do relatório; a binária precisa de arquivo.
+// Retorna 0 ou -1, com a mensagem de erro já impressa
+int series_parse_spec(const char *spec, unsigned long *window, int *format, const char **path);
+
+// window == 0 deixa a série desligada. Abre a saída e começa a thread gravadora; rate é a taxa da
+// amostragem (0 sem ela). Retorna 0 em caso de sucesso
+int series_start(Series *series, unsigned long window, int format, const char *path, double rate);
+
+// Anota a última janela (se ela tiver algum acesso), espera a thread gravar tudo e fecha a saída.
+// Retorna 0 ou -1 se a gravação falhou
+int series_finish(Series *series, const SeriesSample *sample);
+
+// Caminho raro do laço de acessos: anota o fim de uma janela
+void series_record(Series *series, const SeriesSample *sample);
+
+// Hora de anotar uma janela. Desligada, nunca: é a única verificação feita a cada acesso
+static inline int series_due(const Series *series, unsigned long now) {
+    return now >= series->next;
+}
+
+#endif
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "shards.h"
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int shards_parse_spec(const char *spec, double *rate, unsigned *budget) {
+
+    char *end;
+    *rate = strtod(spec, &end);
+    *budget = 0;
+    if (end == spec || *rate <= 0.0 || *rate > 1.0) {
+        fprintf(stderr, "Amostragem inválida: %s (use taxa[/paginas], com 0 < taxa <= 1, por exemplo 0.01 ou 1/8192)\n", spec);
+        return -1;
+    }
+    if (*end == '/') {
+        const char *pages = end + 1;
+        unsigned long value = strtoul(pages, &end, 10);
+        if (end == pages || value == 0 || value > SHARDS_MODULUS) {
+            fprintf(stderr, "Amostragem inválida: %s (o orçamento precisa ter de 1 a %u páginas)\n", spec, SHARDS_MODULUS);
+            return -1;
+        }
+        *budget = (unsigned)value;
+    }
+    if (*end != '\0') {
+        fprintf(stderr, "Amostragem inválida: %s (use taxa[/paginas], por exemplo 0.01 ou 1/8192)\n", spec);
+        return -1;
+    }
+    return 0;
+}
+
+// Menores budget hashes distintos do trace num max-heap; seen marca os hashes já vistos.
+// Um hash visto que não passa da raiz do heap cheio está nele, então seen basta para
+// não contar a mesma página duas vezes. Devolve o limiar que deixa só esses hashes na amostra
+static uint32_t budget_threshold(Shards *shards, const TraceReader *trace, size_t first, unsigned page_shift) {
+
+    uint32_t *heap = (uint32_t *)malloc(shards->budget * sizeof(uint32_t));
+    uint8_t *seen = (uint8_t *)calloc(SHARDS_MODULUS / 8, 1);
+    if (!heap || !seen) {
+        fprintf(stderr, "Erro ao alocar memória para o orçamento da amostragem\n");
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned size = 0;
+    for (size_t i = first; i < trace->batch_count; i++) {
+        uint32_t hash = shards_hash(trace_record(trace, i) >> page_shift);
+        if (seen[hash >> 3] & (1u << (hash & 7))) {
+            continue;
+        }
+        seen[hash >> 3] |= 1u << (hash & 7);
+        shards->distinct_pages++;
+
+        if (size < shards->budget) {
+            unsigned index = size++;
+            while (index > 0 && heap[(index - 1) / 2] < hash) {
+                heap[index] = heap[(index - 1) / 2];
+                index = (index - 1) / 2;
+            }
+            heap[index] = hash;
+        } else if (hash < heap[0]) {
+            unsigned index = 0;
+            for (;;) {
+                unsigned child = 2 * index + 1;
+                if (child >= size) {
+                    break;
+                }
+                if (child + 1 < size && heap[child + 1] > heap[child]) {
+                    child++;
+                }
+                if (heap[child] <= hash) {
+                    break;
+                }
+                heap[index] = heap[child];
+                index = child;
+            }
+            heap[index] = hash;
+        }
+    }
+
+    uint32_t threshold = shards->distinct_pages > shards->budget ? heap[0] + 1 : SHARDS_MODULUS;
+    free(heap);
+    free(seen);
+    return threshold;
+}
+
+int shards_init(Shards *shards, double rate, unsigned budget, TraceReader *trace, unsigned page_shift) {
+
+    memset(shards, 0, sizeof(*shards));
+    if (rate <= 0.0 && budget == 0) {
+        return 0;
+    }
+
+    shards->enabled = 1;
+    shards->requested_rate = rate > 0.0 ? rate : 1.0;
+    shards->budget = budget;
+    shards->threshold = (uint32_t)(shards->requested_rate * SHARDS_MODULUS + 0.5);
+    if (shards->threshold == 0) {
+        shards->threshold = 1;
+    }
+
+    if (budget) {
+        if (trace->format != TRACE_BINARY) {
+            fprintf(stderr, "O orçamento da amostragem só aceita traces binários sem compressão (converta com trace2bin): %s\n",
+                    trace->path);
+            return -1;
+        }
+        double start = now_seconds();
+        uint32_t threshold = budget_threshold(shards, trace, trace->position, page_shift);
+        shards->select_seconds = now_seconds() - start;
+        if (threshold < shards->threshold) {
+            shards->threshold = threshold;
+        }
+    }
+
+    shards->rate = (double)shards->threshold / SHARDS_MODULUS;
+    return 0;
+}
+
+unsigned shards_frames(Shards *shards, unsigned frames) {
+    shards->full_frames = frames;
+    shards->frames = frames;
+    if (shards->enabled) {
+        shards->frames = (unsigned)(frames * shards->rate + 0.5);
+        if (shards->frames == 0) {
+            shards->frames = 1;
+        }
+    }
+    return shards->frames;
+}
+
+void shards_print_stats(const Shards *shards, unsigned long sampled_accesses) {
+
+    if (!shards->enabled) {
+        return;
+    }
+    printf("Amostragem espacial (SHARDS): taxa %.6f, %lu de %lu acessos simulados em %u de %u quadros\n",
+           shards->rate, sampled_accesses, sampled_accesses + shards->skipped_accesses,
+           shards->frames, shards->full_frames);
+    if (shards->budget) {
+        printf("Orcamento da amostra: %u paginas de %lu distintas (taxa pedida %.6f, escolhida em %.3f s)\n",
+               shards->budget, shards->distinct_pages, shards->requested_rate, shards->select_seconds);
+    }
+    printf("Paginas lidas e escritas estimadas para o trace inteiro (amostra / taxa)\n");
+}
@@ -0,0 +1,83 @@
+#ifndef SHARDS_H
+#define SHARDS_H
+
+#include <stdint.h>
+
+#include "trace.h"
+
+// Amostragem espacial no estilo SHARDS (Waldspurger et al., FAST '15), compartilhada pelas
+// tabelas: só entram na simulação os acessos às páginas cujo hash fica abaixo de um
+// limiar, então cada página é simulada inteira ou não é simulada. Com a taxa R = limiar / módulo,
+// a memória simulada é reduzida para R vezes os quadros e as faltas e escritas estimadas são as
+// da amostra divididas por R. Dividir pela taxa, e não pela fração de acessos que caiu na
+// amostra, é a correção do SHARDS ajustado: páginas muito acessadas dentro ou fora da amostra
+// mudam essa fração, mas quase não mudam as faltas.
+// Com um orçamento de páginas, uma passada antes da simulação guarda os menores hashes distintos
+// (um sketch bottom-k) e baixa o limiar até a amostra caber nele, então as tabelas e os quadros
+// simulados não crescem com o trace. A passada precisa dos registros em memória, por isso o
+// orçamento só aceita traces binários mapeados (ou os já carregados pelo sweep): um trace texto,
+// comprimido ou da entrada padrão teria de ficar inteiro na memória
+
+// Módulo do hash, como o P = 2^24 do artigo
+#define SHARDS_MODULUS (1u << 24)
+
+typedef struct {
+    int enabled;
+    uint32_t threshold;             // entram as páginas com hash < threshold
+    double rate;                    // threshold / SHARDS_MODULUS
+    double requested_rate;
+    unsigned budget;                // páginas distintas na amostra; 0 = sem orçamento
+    unsigned long distinct_pages;   // páginas distintas vistas na passada do orçamento
+    double select_seconds;          // tempo dessa passada
+
+    unsigned full_frames;           // quadros da configuração
+    unsigned frames;                // quadros simulados
+    unsigned long skipped_accesses; // acessos fora da amostra
+} Shards;
+
+// Lê "taxa[/paginas]" (ex.: 0.01 ou 1/8192). Retorna 0 ou -1, com a mensagem de erro já impressa
+int shards_parse_spec(const char *spec, double *rate, unsigned *budget);
+
+// rate == 0 e budget == 0 deixam a amostragem desligada. Com orçamento, a passada que escolhe o
+// limiar lê o mapeamento do trace sem consumi-lo; outros formatos são recusados.
+// Retorna 0 em caso de sucesso
+int shards_init(Shards *shards, double rate, unsigned budget, TraceReader *trace, unsigned page_shift);
+
+// Quadros a simular para uma memória de frames quadros (ao menos 1); sem amostragem, os mesmos
+unsigned shards_frames(Shards *shards, unsigned frames);
+
+// Taxa, limiar, acessos e quadros da amostra; não imprime nada sem amostragem
+void shards_print_stats(const Shards *shards, unsigned long sampled_accesses);
+
+// Finalizador de 32 bits do MurmurHash3
+static inline uint32_t shards_mix(uint32_t value) {
+    value ^= value >> 16;
+    value *= 0x85ebca6bu;
+    value ^= value >> 13;
+    value *= 0xc2b2ae35u;
+    value ^= value >> 16;
+    return value;
+}
+
+// Hash da página no intervalo [0, SHARDS_MODULUS). Os 32 bits de cima entram misturados nos de
+// baixo; como o finalizador leva 0 em 0, páginas de 32 bits têm o mesmo hash de sempre
+static inline uint32_t shards_hash(uint64_t page) {
+    return shards_mix((uint32_t)page ^ shards_mix((uint32_t)(page >> 32))) & (SHARDS_MODULUS - 1);
+}
+
+// Uma sequência de 1 + repeats acessos à página fora da amostra: conta e devolve 1 para o
+// laço de acessos pulá-la. Sem amostragem devolve 0 sem calcular o hash
+static inline int shards_skip(Shards *shards, uint64_t page, unsigned long repeats) {
+    if (!shards->enabled || shards_hash(page) < shards->threshold) {
+        return 0;
+    }
+    shards->skipped_accesses += 1 + repeats;
+    return 1;
+}
+
+// Estimativa para o trace inteiro de uma contagem feita na amostra
+static inline unsigned long shards_estimate(const Shards *shards, unsigned long count) {
+    return shards->enabled ? (unsigned long)(count / shards->rate + 0.5) : count;
+}
+
+#endif
@@ -0,0 +1,253 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "prof.h"
+#include "series.h"
+#include "shards.h"
+#include "trace.h"
+#include "tlb.h"
+#include "writeback.h"
+
+// Interface comum dos simuladores (dense, doisNiveis, tresNiveis, quatroNiveis e inverted).
+// Cada simulador é compilado duas vezes: como executável próprio e, com -DSIM_LIBRARY,
+// como objeto sem main para ser ligado ao sweep, que roda várias configurações no mesmo processo.
+// Por isso todo o estado de cada simulador é static no seu arquivo, e _Thread_local para que
+// o sweep possa rodar simulações independentes em paralelo, uma por thread.
+
+// Funções de depuração que nem sempre são chamadas
+#define SIM_UNUSED __attribute__((unused))
+
+// Caminhos raros chamados do laço de acessos, que o compilador deve manter fora dele
+#define SIM_COLD __attribute__((cold, noinline))
+
+// Configuração de uma simulação
+typedef struct {
+    const char *policy;
+    unsigned page_size_kb;
+    unsigned memory_kb;
+    unsigned seed;          // semente da política random
+    double load_factor;     // fator de carga da HAT do inverted; 0 usa o padrão (1.0)
+    unsigned tlb_entries;   // 0 = sem TLB
+    unsigned tlb_ways;
+    int tlb_policy;         // TLB_LRU, TLB_FIFO ou TLB_RANDOM
+    unsigned pwc_entries;   // entradas por nível do cache de percurso das tabelas hierárquicas; 0 = sem cache
+    unsigned wb_period;     // acessos entre despertares do limpador de sujas (writeback.h); 0 = sem limpador
+    unsigned wb_batch;
+    unsigned wb_background_ratio;
+    unsigned wb_dirty_ratio;
+    double sample_rate;     // amostragem espacial (shards.h); 0 = o trace inteiro
+    unsigned sample_budget; // páginas distintas na amostra; 0 = sem orçamento
+    int profile_format;     // perfil do laço de acessos (prof.h); PROF_FORMAT_NONE = sem perfil
+    const char *profile_path;   // NULL = saída padrão
+    unsigned long series_window;    // acessos por janela da série temporal (series.h); 0 = sem série
+    int series_format;              // SERIES_CSV ou SERIES_BINARY
+    const char *series_path;        // NULL = saída padrão
+} SimConfig;
+
+// Semente usada quando nenhuma é informada: é a de um processo que nunca chamou srand()
+#define SIM_DEFAULT_SEED 1
+
+// Entradas por nível do cache de percurso quando nenhum tamanho é informado
+#define SIM_DEFAULT_PWC_ENTRIES 16
+
+// Totais de uma simulação
+typedef struct {
+    unsigned long page_faults;     // Paginas lidas
+    unsigned long pages_written;   // Paginas escritas (nos despejos e pelo limpador)
+    unsigned long accesses;        // Total de acessos à memória
+    unsigned long tlb_hits;        // percursos da tabela evitados pela TLB
+    unsigned long ghost_hits;      // faltas de páginas ainda lembradas como fantasmas (arc, 2q, lirs, clockpro)
+    unsigned long clean_evictions;
+    unsigned long dirty_evictions;
+    unsigned long background_writes;   // escritas antecipadas pelo limpador
+    unsigned long throttled_writes;    // escritas de quem parou no limite de sujas
+    double sample_rate;                // taxa da amostragem espacial; 0 = contagens exatas
+    size_t page_table_bytes;           // pico de memória da tabela de páginas (da amostra, se houver)
+} SimResult;
+
+// Gerador pseudoaleatório de cada simulação. Produz a mesma sequência de srandom()/random()
+// (e de rand(), que na glibc é o mesmo gerador), mas sem estado compartilhado entre threads
+typedef struct {
+    struct random_data data;
+    char state[128];
+} SimRandom;
+
+static inline void sim_random_seed(SimRandom *rng, unsigned seed) {
+    memset(rng, 0, sizeof(*rng));
+    initstate_r(seed, rng->state, sizeof(rng->state), &rng->data);
+}
+
+static inline unsigned sim_random_next(SimRandom *rng) {
+    int32_t value;
+    random_r(&rng->data, &value);
+    return (unsigned)value;
+}
+
+// Políticas de substituição aceitas por todos os simuladores. De arc a clockpro são as resistentes
+// a varreduras de repl.h, na mesma ordem de REPL_* (o tipo é policy - POLICY_ARC); opt é a ótima
+// de Belady (opt.h), que precisa do trace inteiro antes de simular
+enum {
+    POLICY_LRU, POLICY_FIFO, POLICY_RANDOM, POLICY_2A,
+    POLICY_ARC, POLICY_2Q, POLICY_LIRS, POLICY_CLOCKPRO,
+    POLICY_OPT,
+    NUM_POLICIES
+};
+
+#define SIM_POLICY_NAMES "lru, fifo, random, 2a, arc, 2q, lirs, clockpro ou opt"
+
+// Políticas implementadas por repl.c
+static inline int sim_policy_uses_repl(int policy) {
+    return policy >= POLICY_ARC && policy <= POLICY_CLOCKPRO;
+}
+
+// Índice da política (POLICY_*), ou -1 se ela for desconhecida
+static inline int sim_policy_id(const char *policy) {
+    if (strcmp(policy, "lru") == 0) return POLICY_LRU;
+    if (strcmp(policy, "fifo") == 0) return POLICY_FIFO;
+    if (strcmp(policy, "random") == 0) return POLICY_RANDOM;
+    if (strcmp(policy, "2a") == 0) return POLICY_2A;
+    if (strcmp(policy, "arc") == 0) return POLICY_ARC;
+    if (strcmp(policy, "2q") == 0) return POLICY_2Q;
+    if (strcmp(policy, "lirs") == 0) return POLICY_LIRS;
+    if (strcmp(policy, "clockpro") == 0) return POLICY_CLOCKPRO;
+    if (strcmp(policy, "opt") == 0) return POLICY_OPT;
+    return -1;
+}
+
+static inline int sim_policy_known(const char *policy) {
+    return sim_policy_id(policy) >= 0;
+}
+
+// Kernels especializados: o laço de acessos de cada simulador é escrito uma vez, como função
+// SIM_INLINE que recebe a política como parâmetro, e SIM_DEFINE_KERNELS instancia uma cópia por
+// política com o parâmetro constante. Com a expansão forçada o compilador descarta os ramos das
+// outras políticas, então o laço interno não compara strings nem despacha pela política; a escolha
+// do kernel é feita uma única vez, antes da simulação, indexando kernels[] por sim_policy_id()
+#define SIM_INLINE static inline __attribute__((always_inline))
+
+typedef void (*SimKernel)(TraceReader *trace);
+
+#define SIM_DEFINE_KERNELS(simulate)                                                        \
+    static void simulate##_lru(TraceReader *trace) { simulate(trace, POLICY_LRU); }           \
+    static void simulate##_fifo(TraceReader *trace) { simulate(trace, POLICY_FIFO); }         \
+    static void simulate##_random(TraceReader *trace) { simulate(trace, POLICY_RANDOM); }     \
+    static void simulate##_2a(TraceReader *trace) { simulate(trace, POLICY_2A); }             \
+    static void simulate##_arc(TraceReader *trace) { simulate(trace, POLICY_ARC); }           \
+    static void simulate##_2q(TraceReader *trace) { simulate(trace, POLICY_2Q); }             \
+    static void simulate##_lirs(TraceReader *trace) { simulate(trace, POLICY_LIRS); }         \
+    static void simulate##_clockpro(TraceReader *trace) { simulate(trace, POLICY_CLOCKPRO); } \
+    static void simulate##_opt(TraceReader *trace) { simulate(trace, POLICY_OPT); }           \
+    static const SimKernel kernels[NUM_POLICIES] = {                                        \
+        simulate##_lru, simulate##_fifo, simulate##_random, simulate##_2a,                  \
+        simulate##_arc, simulate##_2q, simulate##_lirs, simulate##_clockpro,                \
+        simulate##_opt                                                                      \
+    }
+
+// Opção "tlb=entradas[/vias[/politica]]" dos executáveis. Retorna 1 se arg era a opção da TLB,
+// 0 se não era e -1 se ela estava mal formada
+static inline int sim_parse_tlb_option(const char *arg, SimConfig *config) {
+    if (strncmp(arg, "tlb=", 4) != 0) {
+        return 0;
+    }
+    return tlb_parse_spec(arg + 4, &config->tlb_entries, &config->tlb_ways, &config->tlb_policy) == 0 ? 1 : -1;
+}
+
+// Opção "pwc=entradas" dos executáveis (0 desliga o cache de percurso), com o mesmo retorno
+static inline int sim_parse_pwc_option(const char *arg, SimConfig *config) {
+    if (strncmp(arg, "pwc=", 4) != 0) {
+        return 0;
+    }
+    char *end;
+    unsigned long entries = strtoul(arg + 4, &end, 10);
+    if (end == arg + 4 || *end != '\0' || entries > (1u << 20)) {
+        return -1;
+    }
+    config->pwc_entries = (unsigned)entries;
+    return 1;
+}
+
+// Opção "wb=periodo[/lote[/fundo[/limite]]]" dos executáveis, com o mesmo retorno
+static inline int sim_parse_writeback_option(const char *arg, SimConfig *config) {
+    if (strncmp(arg, "wb=", 3) != 0) {
+        return 0;
+    }
+    return writeback_parse_spec(arg + 3, &config->wb_period, &config->wb_batch,
+                                &config->wb_background_ratio, &config->wb_dirty_ratio) == 0 ? 1 : -1;
+}
+
+// Opção "shards=taxa[/paginas]" dos executáveis, com o mesmo retorno
+static inline int sim_parse_shards_option(const char *arg, SimConfig *config) {
+    if (strncmp(arg, "shards=", 7) != 0) {
+        return 0;
+    }
+    return shards_parse_spec(arg + 7, &config->sample_rate, &config->sample_budget) == 0 ? 1 : -1;
+}
+
+// Opção "prof=formato[:arquivo]" dos executáveis, com o mesmo retorno; só é aceita com a
+// instrumentação compilada (make PROFILE=1)
+static inline int sim_parse_profile_option(const char *arg, SimConfig *config) {
+    if (strncmp(arg, "prof=", 5) != 0) {
+        return 0;
+    }
+    return prof_parse_spec(arg + 5, &config->profile_format, &config->profile_path) == 0 ? 1 : -1;
+}
+
+// Opção "series=janela[/csv|/bin][:arquivo]" dos executáveis, com o mesmo retorno
+static inline int sim_parse_series_option(const char *arg, SimConfig *config) {
+    if (strncmp(arg, "series=", 7) != 0) {
+        return 0;
+    }
+    return series_parse_spec(arg + 7, &config->series_window, &config->series_format, &config->series_path) == 0 ? 1 : -1;
+}
+
+// Numa simulação amostrada, troca as contagens da amostra pelas estimativas para o trace inteiro;
+// os acessos passam a ser os do trace, contando os que ficaram fora da amostra
+static inline void sim_shards_result(const Shards *shards, SimResult *result) {
+    result->page_faults = shards_estimate(shards, result->page_faults);
+    result->pages_written = shards_estimate(shards, result->pages_written);
+    result->tlb_hits = shards_estimate(shards, result->tlb_hits);
+    result->ghost_hits = shards_estimate(shards, result->ghost_hits);
+    result->clean_evictions = shards_estimate(shards, result->clean_evictions);
+    result->dirty_evictions = shards_estimate(shards, result->dirty_evictions);
+    result->background_writes = shards_estimate(shards, result->background_writes);
+    result->throttled_writes = shards_estimate(shards, result->throttled_writes);
+    result->accesses += shards->skipped_accesses;
+    result->sample_rate = shards->enabled ? shards->rate : 0.0;
+}
+
+// Resultado da contagem de despejos e escritas do limpador
+static inline void sim_writeback_result(const Writeback *wb, SimResult *result) {
+    result->clean_evictions = wb->clean_evictions;
+    result->dirty_evictions = wb->dirty_evictions;
+    result->background_writes = wb->background_writes;
+    result->throttled_writes = wb->throttled_writes;
+}
+
+// Opções finais dos executáveis (tlb=, pwc=, wb=, shards=, prof= e series=, em qualquer ordem).
+// Retorna o índice da primeira inválida ou 0 se todas forem aceitas
+static inline int sim_parse_options(int argc, char *argv[], int first, SimConfig *config) {
+    for (int i = first; i < argc; i++) {
+        if (sim_parse_tlb_option(argv[i], config) != 1 && sim_parse_pwc_option(argv[i], config) != 1 &&
+            sim_parse_writeback_option(argv[i], config) != 1 && sim_parse_shards_option(argv[i], config) != 1 &&
+            sim_parse_profile_option(argv[i], config) != 1 && sim_parse_series_option(argv[i], config) != 1) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+// Executa uma simulação completa sobre o trace e preenche o resultado.
+// Retorna 0 em caso de sucesso e -1 para uma configuração inválida
+typedef int (*SimulateFn)(const SimConfig *config, TraceReader *trace, SimResult *result);
+
+int dense_simulate(const SimConfig *config, TraceReader *trace, SimResult *result);
+int doisNiveis_simulate(const SimConfig *config, TraceReader *trace, SimResult *result);
+int tresNiveis_simulate(const SimConfig *config, TraceReader *trace, SimResult *result);
+int quatroNiveis_simulate(const SimConfig *config, TraceReader *trace, SimResult *result);
+int inverted_simulate(const SimConfig *config, TraceReader *trace, SimResult *result);
+
+#endif
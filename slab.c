@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "prof.h"
+#include "slab.h"
+
+void slab_init(Slab *slab, size_t block_size) {
+
+    memset(slab, 0, sizeof(*slab));
+
+    // Todo bloco precisa comportar o ponteiro da lista livre e manter o alinhamento de ponteiros
+    if (block_size < sizeof(void *)) {
+        block_size = sizeof(void *);
+    }
+    slab->block_size = (block_size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+    slab->blocks_per_chunk = SLAB_CHUNK_BYTES / slab->block_size;
+    if (slab->blocks_per_chunk == 0) {
+        slab->blocks_per_chunk = 1;
+    }
+}
+
+static void slab_grow(Slab *slab) {
+
+    if (slab->num_chunks == slab->chunk_capacity) {
+        slab->chunk_capacity = slab->chunk_capacity ? 2 * slab->chunk_capacity : 16;
+        slab->chunks = (void **)realloc(slab->chunks, slab->chunk_capacity * sizeof(void *));
+        if (!slab->chunks) {
+            fprintf(stderr, "Erro ao alocar memória para a tabela de páginas\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    size_t chunk_bytes = slab->blocks_per_chunk * slab->block_size;
+    char *chunk = (char *)calloc(1, chunk_bytes);
+    if (!chunk) {
+        fprintf(stderr, "Erro ao alocar memória para a tabela de páginas\n");
+        exit(EXIT_FAILURE);
+    }
+
+    slab->chunks[slab->num_chunks++] = chunk;
+    PROF_COUNT(PROF_SLAB_CHUNKS, 1);
+    slab->cursor = chunk;
+    slab->chunk_end = chunk + chunk_bytes;
+}
+
+void *slab_alloc(Slab *slab) {
+
+    void *block;
+    if (slab->free_list) {
+        block = slab->free_list;
+        slab->free_list = *(void **)block;
+        *(void **)block = NULL;
+    } else {
+        if (slab->cursor == slab->chunk_end) {
+            slab_grow(slab);
+        }
+        block = slab->cursor;
+        slab->cursor += slab->block_size;
+    }
+
+    slab->live_blocks++;
+    PROF_COUNT(PROF_TABLE_ALLOCS, 1);
+    return block;
+}
+
+void slab_free(Slab *slab, void *block) {
+    *(void **)block = slab->free_list;
+    slab->free_list = block;
+    slab->live_blocks--;
+    PROF_COUNT(PROF_TABLE_FREES, 1);
+}
+
+void slab_destroy(Slab *slab) {
+    for (unsigned i = 0; i < slab->num_chunks; i++) {
+        free(slab->chunks[i]);
+    }
+    free(slab->chunks);
+    memset(slab, 0, sizeof(*slab));
+}
@@ -0,0 +1,42 @@
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <stddef.h>
+
+// Alocador de blocos de tamanho fixo para as tabelas das páginas hierárquicas.
+// Os blocos são cortados de pedaços grandes (SLAB_CHUNK_BYTES) em vez de um malloc por tabela,
+// e os blocos devolvidos entram numa lista livre e são reaproveitados antes de cortar outros.
+// Nada é devolvido ao sistema antes de slab_destroy, que libera todos os pedaços de uma vez.
+// Os pedaços nascem zerados e os blocos só podem ser devolvidos zerados (uma tabela só é liberada
+// quando fica vazia), então a alocação nunca precisa limpar o bloco inteiro
+#define SLAB_CHUNK_BYTES (256 * 1024)
+
+typedef struct {
+    size_t block_size;
+    size_t blocks_per_chunk;
+    void **chunks;
+    unsigned num_chunks;
+    unsigned chunk_capacity;
+    char *cursor;           // próximo bloco ainda não usado do pedaço atual
+    char *chunk_end;
+    void *free_list;        // blocos devolvidos; o primeiro ponteiro de cada um aponta o próximo
+    size_t live_blocks;
+} Slab;
+
+void slab_init(Slab *slab, size_t block_size);
+
+// Bloco zerado
+void *slab_alloc(Slab *slab);
+
+// O bloco precisa estar todo zerado; a primeira palavra passa a ser o elo da lista livre
+void slab_free(Slab *slab, void *block);
+
+// Libera todos os pedaços, inclusive os blocos ainda em uso
+void slab_destroy(Slab *slab);
+
+// Bytes dos blocos em uso
+static inline size_t slab_bytes(const Slab *slab) {
+    return slab->live_blocks * slab->block_size;
+}
+
+#endif
@@ -0,0 +1,341 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <lzma.h>
+
+#include "stream.h"
+
+static const unsigned char gzip_magic[] = {0x1f, 0x8b};
+static const unsigned char xz_magic[] = {0xfd, '7', 'z', 'X', 'Z', 0x00};
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int stream_detect(const unsigned char *magic, size_t len) {
+    if (len >= sizeof(gzip_magic) && memcmp(magic, gzip_magic, sizeof(gzip_magic)) == 0) {
+        return STREAM_GZIP;
+    }
+    if (len >= sizeof(xz_magic) && memcmp(magic, xz_magic, sizeof(xz_magic)) == 0) {
+        return STREAM_XZ;
+    }
+    return -1;
+}
+
+const char *stream_kind_name(int kind) {
+    return kind == STREAM_GZIP ? "gzip" : "xz";
+}
+
+// Lado da thread
+
+// Entrada comprimida: primeiro o prefixo já lido, depois o descritor
+static ssize_t read_input(TraceStream *stream, unsigned char *buffer, size_t size) {
+    if (stream->prefix_len > 0) {
+        size_t n = stream->prefix_len < size ? stream->prefix_len : size;
+        memcpy(buffer, stream->prefix, n);
+        memmove(stream->prefix, stream->prefix + n, stream->prefix_len - n);
+        stream->prefix_len -= n;
+        return (ssize_t)n;
+    }
+    ssize_t n = read(stream->fd, buffer, size);
+    if (n < 0) {
+        perror("Erro ao ler o trace comprimido");
+    } else {
+        stream->bytes_in += n;
+    }
+    return n;
+}
+
+// Bloco da cauda do anel, esperando haver espaço. NULL se o consumidor pediu para parar
+static char *acquire_block(TraceStream *stream) {
+    pthread_mutex_lock(&stream->lock);
+    if (stream->count == STREAM_BLOCKS && !stream->stop) {
+        double start = now_seconds();
+        while (stream->count == STREAM_BLOCKS && !stream->stop) {
+            pthread_cond_wait(&stream->not_full, &stream->lock);
+        }
+        stream->producer_wait_seconds += now_seconds() - start;
+    }
+    char *block = stream->stop ? NULL : stream->blocks[(stream->head + stream->count) % STREAM_BLOCKS];
+    pthread_mutex_unlock(&stream->lock);
+    return block;
+}
+
+static void publish_block(TraceStream *stream, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    pthread_mutex_lock(&stream->lock);
+    stream->lengths[(stream->head + stream->count) % STREAM_BLOCKS] = length;
+    stream->count++;
+    stream->bytes_out += length;
+    pthread_cond_signal(&stream->not_empty);
+    pthread_mutex_unlock(&stream->lock);
+}
+
+static void finish(TraceStream *stream, int failed) {
+    pthread_mutex_lock(&stream->lock);
+    stream->finished = 1;
+    stream->failed = failed;
+    pthread_cond_signal(&stream->not_empty);
+    pthread_mutex_unlock(&stream->lock);
+}
+
+// Membros gzip concatenados são descomprimidos em sequência, como faz o gunzip
+static int run_gzip(TraceStream *stream) {
+
+    unsigned char input[STREAM_INPUT_SIZE];
+    z_stream z;
+    memset(&z, 0, sizeof(z));
+    if (inflateInit2(&z, 15 + 32) != Z_OK) {
+        fprintf(stderr, "Erro ao iniciar o zlib\n");
+        return -1;
+    }
+
+    int result = 0, input_done = 0, member_done = 0, status = Z_OK;
+    char *block = NULL;
+    size_t length = 0;
+
+    for (;;) {
+        if (z.avail_in == 0 && !input_done) {
+            ssize_t n = read_input(stream, input, sizeof(input));
+            if (n < 0) {
+                result = -1;
+                break;
+            }
+            input_done = n == 0;
+            z.next_in = input;
+            z.avail_in = (uInt)n;
+        }
+        // Sem entrada, o inflate ainda pode ter saída pendente: só acaba quando não avança mais
+        if (z.avail_in == 0 && input_done && (member_done || status == Z_BUF_ERROR)) {
+            if (!member_done) {
+                fprintf(stderr, "Trace gzip truncado\n");
+                result = -1;
+            }
+            break;
+        }
+
+        if (!block) {
+            block = acquire_block(stream);
+            length = 0;
+            if (!block) {
+                break;
+            }
+        }
+
+        // Bytes depois do fim de um membro começam o próximo
+        if (member_done) {
+            inflateReset(&z);
+            member_done = 0;
+        }
+
+        z.next_out = (Bytef *)block + length;
+        z.avail_out = (uInt)(STREAM_BLOCK_SIZE - length);
+        status = inflate(&z, Z_NO_FLUSH);
+        length = STREAM_BLOCK_SIZE - z.avail_out;
+
+        if (status == Z_STREAM_END) {
+            member_done = 1;
+        } else if (status != Z_OK && status != Z_BUF_ERROR) {
+            fprintf(stderr, "Erro ao descomprimir o trace gzip: %s\n", z.msg ? z.msg : "dados invalidos");
+            result = -1;
+            break;
+        }
+
+        if (length == STREAM_BLOCK_SIZE) {
+            publish_block(stream, length);
+            block = NULL;
+        }
+    }
+
+    if (block) {
+        publish_block(stream, length);
+    }
+    inflateEnd(&z);
+    return result;
+}
+
+// LZMA_CONCATENATED aceita arquivos .xz concatenados, como o xz -d
+static int run_xz(TraceStream *stream) {
+
+    unsigned char input[STREAM_INPUT_SIZE];
+    lzma_stream x = LZMA_STREAM_INIT;
+    if (lzma_stream_decoder(&x, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK) {
+        fprintf(stderr, "Erro ao iniciar o liblzma\n");
+        return -1;
+    }
+
+    int result = 0;
+    lzma_action action = LZMA_RUN;
+    char *block = NULL;
+    size_t length = 0;
+
+    for (;;) {
+        if (x.avail_in == 0 && action == LZMA_RUN) {
+            ssize_t n = read_input(stream, input, sizeof(input));
+            if (n < 0) {
+                result = -1;
+                break;
+            }
+            if (n == 0) {
+                action = LZMA_FINISH;
+            }
+            x.next_in = input;
+            x.avail_in = (size_t)n;
+        }
+
+        if (!block) {
+            block = acquire_block(stream);
+            length = 0;
+            if (!block) {
+                break;
+            }
+        }
+
+        x.next_out = (uint8_t *)block + length;
+        x.avail_out = STREAM_BLOCK_SIZE - length;
+        lzma_ret status = lzma_code(&x, action);
+        length = STREAM_BLOCK_SIZE - x.avail_out;
+
+        if (length == STREAM_BLOCK_SIZE) {
+            publish_block(stream, length);
+            block = NULL;
+        }
+        if (status == LZMA_STREAM_END) {
+            break;
+        }
+        if (status != LZMA_OK) {
+            fprintf(stderr, "Erro ao descomprimir o trace xz (codigo %d)\n", (int)status);
+            result = -1;
+            break;
+        }
+    }
+
+    if (block) {
+        publish_block(stream, length);
+    }
+    lzma_end(&x);
+    return result;
+}
+
+static void *stream_main(void *arg) {
+    TraceStream *stream = (TraceStream *)arg;
+    int result = stream->kind == STREAM_GZIP ? run_gzip(stream) : run_xz(stream);
+    finish(stream, result != 0);
+    return NULL;
+}
+
+// Lado do consumidor
+
+int stream_start(TraceStream *stream, int kind, int fd, const unsigned char *prefix, size_t prefix_len) {
+
+    memset(stream, 0, sizeof(*stream));
+    stream->kind = kind;
+    stream->fd = fd;
+    if (prefix_len > sizeof(stream->prefix)) {
+        return -1;
+    }
+    memcpy(stream->prefix, prefix, prefix_len);
+    stream->prefix_len = prefix_len;
+    stream->bytes_in = prefix_len;
+
+    for (int i = 0; i < STREAM_BLOCKS; i++) {
+        stream->blocks[i] = (char *)malloc(STREAM_BLOCK_SIZE);
+        if (!stream->blocks[i]) {
+            fprintf(stderr, "Erro ao alocar o anel de descompressao\n");
+            for (int j = 0; j < i; j++) {
+                free(stream->blocks[j]);
+            }
+            return -1;
+        }
+    }
+
+    pthread_mutex_init(&stream->lock, NULL);
+    pthread_cond_init(&stream->not_empty, NULL);
+    pthread_cond_init(&stream->not_full, NULL);
+
+    if (pthread_create(&stream->thread, NULL, stream_main, stream) != 0) {
+        fprintf(stderr, "Erro ao criar a thread de descompressao\n");
+        stream_stop(stream);
+        return -1;
+    }
+    stream->running = 1;
+    return 0;
+}
+
+ssize_t stream_read(TraceStream *stream, void *buffer, size_t size) {
+
+    size_t copied = 0;
+
+    while (copied < size) {
+        pthread_mutex_lock(&stream->lock);
+        if (stream->count == 0 && copied == 0 && !stream->finished) {
+            double start = now_seconds();
+            while (stream->count == 0 && !stream->finished) {
+                pthread_cond_wait(&stream->not_empty, &stream->lock);
+            }
+            stream->consumer_wait_seconds += now_seconds() - start;
+        }
+        int available = stream->count > 0;
+        int failed = stream->failed;
+        pthread_mutex_unlock(&stream->lock);
+
+        if (!available) {
+            if (copied == 0 && failed) {
+                return -1;
+            }
+            break;
+        }
+
+        // O bloco da cabeça é só do consumidor até ser devolvido
+        size_t length = stream->lengths[stream->head];
+        size_t n = length - stream->head_offset;
+        if (n > size - copied) {
+            n = size - copied;
+        }
+        memcpy((char *)buffer + copied, stream->blocks[stream->head] + stream->head_offset, n);
+        copied += n;
+        stream->head_offset += n;
+
+        if (stream->head_offset == length) {
+            pthread_mutex_lock(&stream->lock);
+            stream->head = (stream->head + 1) % STREAM_BLOCKS;
+            stream->count--;
+            stream->head_offset = 0;
+            pthread_cond_signal(&stream->not_full);
+            pthread_mutex_unlock(&stream->lock);
+        }
+    }
+
+    return (ssize_t)copied;
+}
+
+void stream_stop(TraceStream *stream) {
+
+    if (!stream->blocks[0]) {
+        return;
+    }
+
+    if (stream->running) {
+        pthread_mutex_lock(&stream->lock);
+        stream->stop = 1;
+        pthread_cond_signal(&stream->not_full);
+        pthread_mutex_unlock(&stream->lock);
+        pthread_join(stream->thread, NULL);
+        stream->running = 0;
+    }
+
+    pthread_mutex_destroy(&stream->lock);
+    pthread_cond_destroy(&stream->not_empty);
+    pthread_cond_destroy(&stream->not_full);
+    for (int i = 0; i < STREAM_BLOCKS; i++) {
+        free(stream->blocks[i]);
+        stream->blocks[i] = NULL;
+    }
+}
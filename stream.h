@@ -0,0 +1,69 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/types.h>
+
+// Descompressão de traces gzip e xz em fluxo. Uma thread própria lê o arquivo (ou a entrada
+// padrão), descomprime e entrega os bytes num anel limitado de blocos, de onde o leitor de trace
+// os consome; assim a descompressão de um bloco sobrepõe a simulação do anterior e a memória
+// usada não depende do tamanho do trace. Um produtor e um consumidor: o bloco da cauda só é
+// escrito pela thread e o da cabeça só é lido pelo consumidor, então a trava protege apenas os índices
+
+enum { STREAM_GZIP, STREAM_XZ };
+
+#define STREAM_BLOCK_SIZE (256 << 10)
+#define STREAM_BLOCKS 8
+// Entrada comprimida lida do descritor de cada vez
+#define STREAM_INPUT_SIZE (64 << 10)
+// Início da entrada que pode ter sido lido antes de a thread começar
+#define STREAM_PREFIX_MAX 16
+
+typedef struct TraceStream {
+    int kind;
+    int fd;
+    pthread_t thread;
+    int running;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+
+    char *blocks[STREAM_BLOCKS];
+    size_t lengths[STREAM_BLOCKS];
+    unsigned head;          // próximo bloco a consumir
+    unsigned count;         // blocos prontos
+    size_t head_offset;     // bytes já consumidos do bloco da cabeça
+    int finished;           // a thread não vai mais produzir
+    int failed;
+    int stop;               // pedido do consumidor para a thread parar
+
+    // Início da entrada comprimida que já foi lido do descritor para detectar o formato
+    unsigned char prefix[STREAM_PREFIX_MAX];
+    size_t prefix_len;
+
+    // Estatísticas
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+    double consumer_wait_seconds;   // simulação parada esperando dados
+    double producer_wait_seconds;   // descompressão parada com o anel cheio
+} TraceStream;
+
+// Compressão reconhecida pelos primeiros bytes (STREAM_GZIP ou STREAM_XZ), ou -1
+int stream_detect(const unsigned char *magic, size_t len);
+
+// Começa a descomprimir fd numa thread. prefix são os bytes do início da entrada que já foram
+// lidos do descritor (de um pipe, para detectar o formato). Retorna 0 em caso de sucesso
+int stream_start(TraceStream *stream, int kind, int fd, const unsigned char *prefix, size_t prefix_len);
+
+// Copia até size bytes descomprimidos, esperando só se nenhum estiver pronto.
+// Retorna quantos foram copiados, 0 no fim e -1 se a descompressão falhou
+ssize_t stream_read(TraceStream *stream, void *buffer, size_t size);
+
+// Para a thread (se ainda estiver produzindo) e libera o anel. Não fecha o descritor
+void stream_stop(TraceStream *stream);
+
+const char *stream_kind_name(int kind);
+
+#endif
@@ -0,0 +1,594 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "trace.h"
+#include "sim.h"
+#include "scheduler.h"
+
+// Modo sweep: lê cada trace uma única vez e roda todas as combinações de
+// (tabela, algoritmo, memória, página) no mesmo processo, gerando uma tabela consolidada.
+// Substitui as 576 chamadas de ./tp2virtual feitas pelo teste.c.
+// As simulações são jobs independentes, executados em paralelo pelo escalonador;
+// a tabela sai sempre na ordem da matriz e com os mesmos números de uma execução serial
+
+#define MAX_VALUES 64
+
+typedef struct {
+    const char *name;
+    SimulateFn simulate;
+} TableType;
+
+static const TableType table_types[] = {
+    {"dense", dense_simulate},
+    {"doisNiveis", doisNiveis_simulate},
+    {"tresNiveis", tresNiveis_simulate},
+    {"quatroNiveis", quatroNiveis_simulate},
+    {"inverted", inverted_simulate},
+};
+
+#define NUM_TABLE_TYPES (sizeof(table_types) / sizeof(table_types[0]))
+
+// Uma dimensão da matriz de configurações (lista de valores em texto)
+typedef struct {
+    char *values[MAX_VALUES];
+    int count;
+} ValueList;
+
+typedef struct {
+    ValueList tables;
+    ValueList policies;
+    ValueList page_sizes;
+    ValueList memory_sizes;
+    ValueList files;
+    int csv;
+    int threads;
+    unsigned seed;
+    unsigned tlb_entries;   // 0 = sem TLB
+    unsigned tlb_ways;
+    int tlb_policy;
+    unsigned pwc_entries;   // cache de percurso das tabelas hierárquicas
+    unsigned wb_period;     // limpador de sujas; 0 = sem limpador
+    unsigned wb_batch;
+    unsigned wb_background_ratio;
+    unsigned wb_dirty_ratio;
+    double sample_rate;     // amostragem espacial; 0 = trace inteiro
+    unsigned sample_budget;
+    int compare;            // roda também a simulação completa e mede o erro da amostrada
+    int resources;          // roda cada simulação num processo próprio e mede a memória dela
+} SweepMatrix;
+
+// Uma simulação da matriz
+typedef struct {
+    int trace_index;
+    const TableType *table;
+    SimConfig config;
+    SimResult result;
+    int status;
+    double seconds;
+    SimResult exact;        // simulação completa, com -E
+    double exact_seconds;
+    long rss_kb;            // pico de memória residente do processo da simulação, com -R
+} SweepJob;
+
+typedef struct {
+    TraceBuffer *traces;
+    SweepJob *jobs;
+    int compare;
+    int isolate;
+} SweepRun;
+
+static void usage(const char *program) {
+    fprintf(stderr,
+            "Uso: %s [-f matriz.cfg] [-t tabelas] [-a algoritmos] [-p paginas_kb] [-m memorias_kb] [-j threads] [-s semente] [-T tlb] [-W entradas] [-B limpador] [-S amostra] [-E] [-R] [-c] [arquivo.log ...]\n\n"
+            "As listas são separadas por vírgula, por exemplo: -a lru,fifo -p 2,16,64\n"
+            "O arquivo de matriz tem uma dimensão por linha: tabelas, algoritmos, paginas, memorias ou arquivos,\n"
+            "seguida dos valores separados por espaço ou vírgula. Linhas iniciadas por # são ignoradas.\n"
+            "-j define o número de threads (padrão: um por processador)\n"
+            "-s fixa a semente da política random (padrão: %d)\n"
+            "-T coloca uma TLB entradas[/vias[/politica]] na frente de todas as tabelas, ex.: -T 64/4/lru\n"
+            "-W define as entradas por nível do cache de percurso de doisNiveis, tresNiveis e quatroNiveis (padrão: %d; 0 desliga)\n"
+            "-B liga o limpador de páginas sujas periodo[/lote[/fundo[/limite]]] em todas as tabelas, ex.: -B 10000/32/10/20\n"
+            "-S simula só uma amostra das páginas (SHARDS) com taxa[/paginas], ex.: -S 0.01 ou -S 1/8192\n"
+            "-E roda também cada simulação completa e mostra o erro das estimativas da amostra\n"
+            "-R roda cada simulação num processo próprio e mostra ns por acesso, o pico da tabela de páginas\n"
+            "   e o pico de memória residente do processo (que inclui os traces carregados)\n"
+            "-c gera a tabela em CSV\n", program, SIM_DEFAULT_SEED, SIM_DEFAULT_PWC_ENTRIES);
+    exit(EXIT_FAILURE);
+}
+
+// Substitui a lista pelos valores de text, separados por vírgula ou espaço
+static void parse_list(ValueList *list, const char *text) {
+
+    char *copy = strdup(text);
+    list->count = 0;
+
+    for (char *token = strtok(copy, ", \t\r\n"); token; token = strtok(NULL, ", \t\r\n")) {
+        if (list->count == MAX_VALUES) {
+            fprintf(stderr, "Máximo de %d valores por dimensão\n", MAX_VALUES);
+            exit(EXIT_FAILURE);
+        }
+        list->values[list->count++] = strdup(token);
+    }
+    free(copy);
+}
+
+static void load_matrix_file(SweepMatrix *matrix, const char *path) {
+
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror("Erro ao abrir o arquivo de matriz");
+        exit(EXIT_FAILURE);
+    }
+
+    char line[4096];
+    while (fgets(line, sizeof(line), file)) {
+
+        char *key = line + strspn(line, " \t");
+        if (*key == '#' || *key == '\n' || *key == '\r' || *key == '\0') {
+            continue;
+        }
+
+        // "chave: valores", "chave = valores" ou "chave valores"
+        size_t key_length = strcspn(key, " \t:=\r\n");
+        char *values = key + key_length + strspn(key + key_length, " \t:=");
+        key[key_length] = '\0';
+
+        if (strcmp(key, "tabelas") == 0) {
+            parse_list(&matrix->tables, values);
+        } else if (strcmp(key, "algoritmos") == 0) {
+            parse_list(&matrix->policies, values);
+        } else if (strcmp(key, "paginas") == 0) {
+            parse_list(&matrix->page_sizes, values);
+        } else if (strcmp(key, "memorias") == 0) {
+            parse_list(&matrix->memory_sizes, values);
+        } else if (strcmp(key, "arquivos") == 0) {
+            parse_list(&matrix->files, values);
+        } else {
+            fprintf(stderr, "Dimensão desconhecida no arquivo de matriz: %s\n", key);
+            exit(EXIT_FAILURE);
+        }
+    }
+    fclose(file);
+}
+
+static const TableType *find_table_type(const char *name) {
+    for (unsigned i = 0; i < NUM_TABLE_TYPES; i++) {
+        if (strcmp(table_types[i].name, name) == 0) {
+            return &table_types[i];
+        }
+    }
+    return NULL;
+}
+
+// Aplica os mesmos limites do tp2virtual antes de carregar qualquer trace
+static void validate_matrix(const SweepMatrix *matrix) {
+
+    for (int i = 0; i < matrix->tables.count; i++) {
+        if (!find_table_type(matrix->tables.values[i])) {
+            fprintf(stderr, "Tabela desconhecida: %s (use dense, doisNiveis, tresNiveis, quatroNiveis ou inverted)\n", matrix->tables.values[i]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int i = 0; i < matrix->policies.count; i++) {
+        if (!sim_policy_known(matrix->policies.values[i])) {
+            fprintf(stderr, "Algoritmo de substituição desconhecido: %s (use " SIM_POLICY_NAMES ")\n", matrix->policies.values[i]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int i = 0; i < matrix->page_sizes.count; i++) {
+        int page = atoi(matrix->page_sizes.values[i]);
+        if (page < 2 || page > 64) {
+            fprintf(stderr, "Tamanho de quadro %d fora dos limites de 2 KB a 64 KB\n", page);
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int i = 0; i < matrix->memory_sizes.count; i++) {
+        int memory = atoi(matrix->memory_sizes.values[i]);
+        if (memory < 128 || memory > 16384) {
+            fprintf(stderr, "Tamanho de memoria %d fora dos limites de 128 KB a 16 MB\n", memory);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (matrix->files.count == 0) {
+        fprintf(stderr, "Nenhum arquivo de trace informado\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Com a TLB ligada, cada linha ganha a taxa de acertos e os percursos evitados no fim; com alguma
+// política de repl.c na matriz, ganha também as faltas que acertaram fantasmas (0 nas demais);
+// com o limpador ligado, as escritas divididas entre despejos sujos, limpador e paradas no limite;
+// com amostragem, a taxa usada (as contagens já são estimativas) e, com -E, os valores exatos e o
+// erro relativo das estimativas; com -R, o custo por acesso e a memória de cada simulação
+static void print_header(const SweepMatrix *matrix, int ghosts) {
+    int tlb = matrix->tlb_entries > 0;
+    int writeback = matrix->wb_period > 0;
+    int sampling = matrix->sample_rate > 0;
+    if (matrix->csv) {
+        printf("arquivo,tabela,algoritmo,pagina_kb,memoria_kb,paginas_lidas,paginas_escritas,acessos,tempo_ms,acessos_por_s%s%s%s%s%s%s\n",
+               tlb ? ",tlb_acertos_pct,percursos_evitados" : "", ghosts ? ",acertos_fantasma" : "",
+               writeback ? ",despejos_limpos,despejos_sujos,escritas_fundo,escritas_limite" : "",
+               sampling ? ",taxa_amostra" : "",
+               matrix->compare ? ",lidas_exatas,erro_lidas_pct,escritas_exatas,erro_escritas_pct,tempo_exato_ms" : "",
+               matrix->resources ? ",ns_por_acesso,tabela_bytes,rss_pico_kb" : "");
+    } else {
+        printf("%-30s %-10s %-9s %9s %10s %14s %16s %12s %10s %13s",
+               "arquivo", "tabela", "algoritmo", "pagina_kb", "memoria_kb",
+               "paginas_lidas", "paginas_escritas", "acessos", "tempo_ms", "acessos_por_s");
+        if (tlb) {
+            printf(" %15s %18s", "tlb_acertos_pct", "percursos_evitados");
+        }
+        if (ghosts) {
+            printf(" %16s", "acertos_fantasma");
+        }
+        if (writeback) {
+            printf(" %15s %14s %14s %15s", "despejos_limpos", "despejos_sujos", "escritas_fundo", "escritas_limite");
+        }
+        if (sampling) {
+            printf(" %12s", "taxa_amostra");
+        }
+        if (matrix->compare) {
+            printf(" %13s %14s %15s %17s %14s", "lidas_exatas", "erro_lidas_pct", "escritas_exatas", "erro_escritas_pct", "tempo_exato_ms");
+        }
+        if (matrix->resources) {
+            printf(" %13s %12s %11s", "ns_por_acesso", "tabela_bytes", "rss_pico_kb");
+        }
+        printf("\n");
+    }
+}
+
+// Erro relativo da estimativa, em %
+static double relative_error(unsigned long estimate, unsigned long exact) {
+    return exact ? 100.0 * ((double)estimate - (double)exact) / exact : 0.0;
+}
+
+static void print_row(const SweepMatrix *matrix, int ghosts, const char *file, const SweepJob *job) {
+
+    const SimResult *result = &job->result;
+    const SimResult *exact = &job->exact;
+    double rate = job->seconds > 0 ? result->accesses / job->seconds : 0.0;
+    double tlb_hit_rate = result->accesses ? 100.0 * result->tlb_hits / result->accesses : 0.0;
+    double ns_per_access = result->accesses ? job->seconds * 1e9 / result->accesses : 0.0;
+    int csv = matrix->csv;
+
+    if (csv) {
+        printf("%s,%s,%s,%u,%u,%lu,%lu,%lu,%.3f,%.0f", file, job->table->name, job->config.policy,
+               job->config.page_size_kb, job->config.memory_kb,
+               result->page_faults, result->pages_written, result->accesses, job->seconds * 1e3, rate);
+        if (job->config.tlb_entries) {
+            printf(",%.2f,%lu", tlb_hit_rate, result->tlb_hits);
+        }
+        if (ghosts) {
+            printf(",%lu", result->ghost_hits);
+        }
+        if (job->config.wb_period) {
+            printf(",%lu,%lu,%lu,%lu", result->clean_evictions, result->dirty_evictions,
+                   result->background_writes, result->throttled_writes);
+        }
+        if (matrix->sample_rate > 0) {
+            printf(",%.6f", result->sample_rate);
+        }
+        if (matrix->compare) {
+            printf(",%lu,%.2f,%lu,%.2f,%.3f", exact->page_faults, relative_error(result->page_faults, exact->page_faults),
+                   exact->pages_written, relative_error(result->pages_written, exact->pages_written),
+                   job->exact_seconds * 1e3);
+        }
+        if (matrix->resources) {
+            printf(",%.2f,%zu,%ld", ns_per_access, result->page_table_bytes, job->rss_kb);
+        }
+    } else {
+        printf("%-30s %-10s %-9s %9u %10u %14lu %16lu %12lu %10.1f %13.0f", file, job->table->name, job->config.policy,
+               job->config.page_size_kb, job->config.memory_kb,
+               result->page_faults, result->pages_written, result->accesses, job->seconds * 1e3, rate);
+        if (job->config.tlb_entries) {
+            printf(" %15.2f %18lu", tlb_hit_rate, result->tlb_hits);
+        }
+        if (ghosts) {
+            printf(" %16lu", result->ghost_hits);
+        }
+        if (job->config.wb_period) {
+            printf(" %15lu %14lu %14lu %15lu", result->clean_evictions, result->dirty_evictions,
+                   result->background_writes, result->throttled_writes);
+        }
+        if (matrix->sample_rate > 0) {
+            printf(" %12.6f", result->sample_rate);
+        }
+        if (matrix->compare) {
+            printf(" %13lu %14.2f %15lu %17.2f %14.1f", exact->page_faults, relative_error(result->page_faults, exact->page_faults),
+                   exact->pages_written, relative_error(result->pages_written, exact->pages_written),
+                   job->exact_seconds * 1e3);
+        }
+        if (matrix->resources) {
+            printf(" %13.2f %12zu %11ld", ns_per_access, result->page_table_bytes, job->rss_kb);
+        }
+    }
+    printf("\n");
+}
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Resultado de uma simulação feita num processo filho, devolvido pelo pipe
+typedef struct {
+    int status;
+    SimResult result;
+    double seconds;
+} ChildReport;
+
+// Roda a simulação num processo filho, que herda os traces já carregados, e mede o pico de
+// memória residente dele. Retorna o status da simulação
+static int simulate_in_child(const SweepJob *job, const SimConfig *config, TraceBuffer *trace,
+                             SimResult *result, double *seconds, long *rss_kb) {
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("Erro ao criar o pipe da simulação");
+        return -1;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("Erro ao criar o processo da simulação");
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+        ChildReport report;
+        memset(&report, 0, sizeof(report));
+        TraceReader reader;
+        trace_open_buffer(&reader, trace);
+        double start = now_seconds();
+        report.status = job->table->simulate(config, &reader, &report.result);
+        report.seconds = now_seconds() - start;
+        ssize_t written = write(fds[1], &report, sizeof(report));
+        _exit(written == (ssize_t)sizeof(report) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    ChildReport report;
+    size_t received = 0;
+    while (received < sizeof(report)) {
+        ssize_t n = read(fds[0], (char *)&report + received, sizeof(report) - received);
+        if (n <= 0) {
+            break;
+        }
+        received += n;
+    }
+    close(fds[0]);
+
+    int wait_status;
+    struct rusage usage;
+    if (wait4(pid, &wait_status, 0, &usage) < 0 || received < sizeof(report) ||
+        !WIFEXITED(wait_status) || WEXITSTATUS(wait_status) != 0) {
+        fprintf(stderr, "O processo da simulação %s/%s terminou sem resultado\n", job->table->name, config->policy);
+        return -1;
+    }
+
+    *result = report.result;
+    *seconds = report.seconds;
+    *rss_kb = usage.ru_maxrss;
+    return report.status;
+}
+
+// Roda uma simulação do job nesta thread ou, com -R, num processo próprio
+static int simulate_job(SweepRun *run, SweepJob *job, const SimConfig *config, SimResult *result, double *seconds) {
+
+    TraceBuffer *trace = &run->traces[job->trace_index];
+    if (run->isolate) {
+        return simulate_in_child(job, config, trace, result, seconds, &job->rss_kb);
+    }
+
+    TraceReader reader;
+    trace_open_buffer(&reader, trace);
+    double start = now_seconds();
+    int status = job->table->simulate(config, &reader, result);
+    *seconds = now_seconds() - start;
+    return status;
+}
+
+// Executa um job; roda numa thread do escalonador
+static void run_job(void *arg, int index) {
+
+    SweepRun *run = (SweepRun *)arg;
+    SweepJob *job = &run->jobs[index];
+
+    // A simulação completa usa a mesma configuração sem a amostragem
+    if (run->compare) {
+        SimConfig exact_config = job->config;
+        exact_config.sample_rate = 0;
+        exact_config.sample_budget = 0;
+        job->status = simulate_job(run, job, &exact_config, &job->exact, &job->exact_seconds);
+        if (job->status != 0) {
+            return;
+        }
+    }
+
+    job->status = simulate_job(run, job, &job->config, &job->result, &job->seconds);
+}
+
+int main(int argc, char *argv[]) {
+
+    // Matriz padrão: a mesma do teste.c
+    SweepMatrix matrix;
+    memset(&matrix, 0, sizeof(matrix));
+    parse_list(&matrix.tables, "dense,doisNiveis,tresNiveis,quatroNiveis,inverted");
+    parse_list(&matrix.policies, "lru,2a,fifo,random");
+    parse_list(&matrix.page_sizes, "2,16,64");
+    parse_list(&matrix.memory_sizes, "256,2048,16384");
+
+    matrix.threads = scheduler_default_threads();
+    matrix.seed = SIM_DEFAULT_SEED;
+    matrix.pwc_entries = SIM_DEFAULT_PWC_ENTRIES;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "f:t:a:p:m:j:s:T:W:B:S:ERc")) != -1) {
+        switch (opt) {
+            case 'f': load_matrix_file(&matrix, optarg); break;
+            case 't': parse_list(&matrix.tables, optarg); break;
+            case 'a': parse_list(&matrix.policies, optarg); break;
+            case 'p': parse_list(&matrix.page_sizes, optarg); break;
+            case 'm': parse_list(&matrix.memory_sizes, optarg); break;
+            case 'j': matrix.threads = atoi(optarg); break;
+            case 's': matrix.seed = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'T':
+                if (tlb_parse_spec(optarg, &matrix.tlb_entries, &matrix.tlb_ways, &matrix.tlb_policy) != 0) {
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'W': matrix.pwc_entries = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'B':
+                if (writeback_parse_spec(optarg, &matrix.wb_period, &matrix.wb_batch,
+                                         &matrix.wb_background_ratio, &matrix.wb_dirty_ratio) != 0) {
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'S':
+                if (shards_parse_spec(optarg, &matrix.sample_rate, &matrix.sample_budget) != 0) {
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'E': matrix.compare = 1; break;
+            case 'R': matrix.resources = 1; break;
+            case 'c': matrix.csv = 1; break;
+            default: usage(argv[0]);
+        }
+    }
+
+    if (optind < argc) {
+        matrix.files.count = 0;
+        for (int i = optind; i < argc && matrix.files.count < MAX_VALUES; i++) {
+            matrix.files.values[matrix.files.count++] = argv[i];
+        }
+    }
+
+    validate_matrix(&matrix);
+    if (matrix.compare && matrix.sample_rate == 0) {
+        fprintf(stderr, "-E compara a simulação amostrada com a completa e precisa de -S\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Cada trace é lido uma vez e compartilhado (somente leitura) por todos os jobs
+    SweepRun run;
+    run.compare = matrix.compare;
+    run.isolate = matrix.resources;
+    run.traces = (TraceBuffer *)calloc(matrix.files.count, sizeof(TraceBuffer));
+    for (int i_arq = 0; i_arq < matrix.files.count; i_arq++) {
+
+        const char *path = matrix.files.values[i_arq];
+        double start = now_seconds();
+
+        if (trace_load(&run.traces[i_arq], path) != 0) {
+            fprintf(stderr, "Erro ao abrir o arquivo %s.\n", path);
+            exit(EXIT_FAILURE);
+        }
+        fprintf(stderr, "%s: %zu acessos carregados em %.2f s\n", path, run.traces[i_arq].count, now_seconds() - start);
+    }
+
+    int num_jobs = matrix.files.count * matrix.tables.count * matrix.policies.count *
+                   matrix.memory_sizes.count * matrix.page_sizes.count;
+    run.jobs = (SweepJob *)calloc(num_jobs + 1, sizeof(SweepJob));
+    double *costs = (double *)calloc(num_jobs + 1, sizeof(double));
+    if (!run.traces || !run.jobs || !costs) {
+        fprintf(stderr, "Erro ao alocar memória para o sweep\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int n = 0;
+    for (int i_arq = 0; i_arq < matrix.files.count; i_arq++) {
+        for (int i_tab = 0; i_tab < matrix.tables.count; i_tab++) {
+            for (int i_alg = 0; i_alg < matrix.policies.count; i_alg++) {
+                for (int i_mem = 0; i_mem < matrix.memory_sizes.count; i_mem++) {
+                    for (int i_pag = 0; i_pag < matrix.page_sizes.count; i_pag++) {
+                        SweepJob *job = &run.jobs[n];
+                        job->trace_index = i_arq;
+                        job->table = find_table_type(matrix.tables.values[i_tab]);
+                        job->config.policy = matrix.policies.values[i_alg];
+                        job->config.memory_kb = atoi(matrix.memory_sizes.values[i_mem]);
+                        job->config.page_size_kb = atoi(matrix.page_sizes.values[i_pag]);
+                        job->config.seed = matrix.seed;
+                        job->config.tlb_entries = matrix.tlb_entries;
+                        job->config.tlb_ways = matrix.tlb_ways;
+                        job->config.tlb_policy = matrix.tlb_policy;
+                        job->config.pwc_entries = matrix.pwc_entries;
+                        job->config.wb_period = matrix.wb_period;
+                        job->config.wb_batch = matrix.wb_batch;
+                        job->config.wb_background_ratio = matrix.wb_background_ratio;
+                        job->config.wb_dirty_ratio = matrix.wb_dirty_ratio;
+                        job->config.sample_rate = matrix.sample_rate;
+                        job->config.sample_budget = matrix.sample_budget;
+                        // O custo de cada simulação é proporcional ao tamanho do trace
+                        costs[n] = (double)run.traces[i_arq].count;
+                        n++;
+                    }
+                }
+            }
+        }
+    }
+
+    double start = now_seconds();
+    double busy_seconds = 0;
+    Scheduler *scheduler = scheduler_start(matrix.threads, num_jobs, costs, run_job, &run);
+
+    int ghosts = 0;
+    for (int i = 0; i < matrix.policies.count; i++) {
+        ghosts |= sim_policy_uses_repl(sim_policy_id(matrix.policies.values[i]));
+    }
+
+    // Os resultados são impressos na ordem da matriz, assim que cada um fica pronto
+    print_header(&matrix, ghosts);
+    for (int i = 0; i < num_jobs; i++) {
+        scheduler_wait_job(scheduler, i);
+        if (run.jobs[i].status != 0) {
+            exit(EXIT_FAILURE);
+        }
+        print_row(&matrix, ghosts, matrix.files.values[run.jobs[i].trace_index], &run.jobs[i]);
+        fflush(stdout);
+        busy_seconds += run.jobs[i].seconds + run.jobs[i].exact_seconds;
+    }
+    scheduler_finish(scheduler);
+
+    double elapsed = now_seconds() - start;
+    fprintf(stderr, "%d simulações em %.2f s com %d threads (%.2f s somados de simulação, paralelismo médio de %.1fx)\n",
+            num_jobs, elapsed, matrix.threads, busy_seconds, elapsed > 0 ? busy_seconds / elapsed : 0.0);
+
+    // Resumo da precisão: erro absoluto das páginas lidas e quanto a amostra poupou de simulação
+    if (matrix.compare) {
+        double error_sum = 0, error_max = 0, exact_seconds = 0, sampled_seconds = 0;
+        for (int i = 0; i < num_jobs; i++) {
+            double error = relative_error(run.jobs[i].result.page_faults, run.jobs[i].exact.page_faults);
+            if (error < 0) {
+                error = -error;
+            }
+            error_sum += error;
+            if (error > error_max) {
+                error_max = error;
+            }
+            exact_seconds += run.jobs[i].exact_seconds;
+            sampled_seconds += run.jobs[i].seconds;
+        }
+        fprintf(stderr, "Erro das paginas lidas estimadas: %.2f%% em media, %.2f%% no maximo; "
+                "simulacao amostrada %.1fx mais rapida (%.2f s contra %.2f s)\n",
+                num_jobs ? error_sum / num_jobs : 0.0, error_max,
+                sampled_seconds > 0 ? exact_seconds / sampled_seconds : 0.0, sampled_seconds, exact_seconds);
+    }
+
+    for (int i_arq = 0; i_arq < matrix.files.count; i_arq++) {
+        trace_buffer_free(&run.traces[i_arq]);
+    }
+    free(run.traces);
+    free(run.jobs);
+    free(costs);
+
+    return 0;
+}
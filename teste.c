@@ -6,7 +6,7 @@
 
 int main(int argc, char *argv[]) {
 
-    char command[800];
+    char command[4096];
 
     char algoritmos[4][256];
     sprintf(algoritmos[0], "lru");
@@ -25,28 +25,24 @@ int main(int argc, char *argv[]) {
     sprintf(arquivos[2], "compressor/compressor.log");
     sprintf(arquivos[3], "simulador/simulador.log");
 
-    char tabelas[4][256];
+    char tabelas[5][256];
 
     sprintf(tabelas[0], "dense");
     sprintf(tabelas[1], "doisNiveis");
     sprintf(tabelas[2], "tresNiveis");
-    sprintf(tabelas[3], "inverted");
-
-    for (int i_tabelas = 0; i_tabelas < 4; i_tabelas++){
-         for (int i_arq = 0; i_arq < 4; i_arq++){
-            for (int i_alg = 0; i_alg < 4; i_alg++){
-                 for (int i_mem = 0; i_mem < 3; i_mem++){
-                     for (int i_pag = 0; i_pag < 3; i_pag++){
-                                           
-                        sprintf(command, "./tp2virtual %s %s %d %d %s", algoritmos[i_alg], arquivos[i_arq], valor_pagina[i_pag], valor_mem[i_mem], tabelas[i_tabelas]);
-
-                        system(command);
-
-                    }
-                }
-            }
-        }
-    }
+    sprintf(tabelas[3], "quatroNiveis");
+    sprintf(tabelas[4], "inverted");
+
+    // Todas as combinações rodam num único processo do sweep, que lê cada trace uma vez
+    // (antes eram 576 chamadas de ./tp2virtual, uma por combinação)
+    snprintf(command, sizeof(command), "./sweep -a %s,%s,%s,%s -p %d,%d,%d -m %d,%d,%d -t %s,%s,%s,%s,%s %s %s %s %s",
+            algoritmos[0], algoritmos[1], algoritmos[2], algoritmos[3],
+            valor_pagina[0], valor_pagina[1], valor_pagina[2],
+            valor_mem[0], valor_mem[1], valor_mem[2],
+            tabelas[0], tabelas[1], tabelas[2], tabelas[3], tabelas[4],
+            arquivos[0], arquivos[1], arquivos[2], arquivos[3]);
+
+    system(command);
 
     return 0;
 
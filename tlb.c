@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tlb.h"
+
+static const char *policy_names[NUM_TLB_POLICIES] = {"lru", "fifo", "random"};
+
+const char *tlb_policy_name(int policy) {
+    return policy >= 0 && policy < NUM_TLB_POLICIES ? policy_names[policy] : "?";
+}
+
+int tlb_parse_spec(const char *spec, unsigned *entries, unsigned *ways, int *policy) {
+
+    char *end;
+    unsigned long value = strtoul(spec, &end, 10);
+    *entries = (unsigned)value;
+    *ways = (unsigned)value;
+    *policy = TLB_LRU;
+
+    if (end != spec && *end == '/') {
+        const char *ways_text = end + 1;
+        value = strtoul(ways_text, &end, 10);
+        *ways = end != ways_text ? (unsigned)value : 0;
+    }
+    if (*end == '/') {
+        const char *name = end + 1;
+        *policy = -1;
+        for (int i = 0; i < NUM_TLB_POLICIES; i++) {
+            if (strcmp(name, policy_names[i]) == 0) {
+                *policy = i;
+            }
+        }
+        if (*policy < 0) {
+            fprintf(stderr, "Política de substituição da TLB desconhecida: %s (use lru, fifo ou random)\n", name);
+            return -1;
+        }
+    } else if (*end != '\0') {
+        fprintf(stderr, "TLB inválida: %s (use entradas[/vias[/politica]], por exemplo 64/4/lru)\n", spec);
+        return -1;
+    }
+
+    if (*entries == 0 || *ways == 0 || *entries % *ways != 0) {
+        fprintf(stderr, "TLB inválida: %s (o número de entradas precisa ser múltiplo do número de vias)\n", spec);
+        return -1;
+    }
+    unsigned sets = *entries / *ways;
+    if (sets & (sets - 1)) {
+        fprintf(stderr, "TLB inválida: %s (entradas / vias precisa ser potência de 2)\n", spec);
+        return -1;
+    }
+    return 0;
+}
+
+void tlb_init(Tlb *tlb, unsigned entries, unsigned ways, int policy) {
+
+    memset(tlb, 0, sizeof(*tlb));
+    if (entries == 0) {
+        return;
+    }
+
+    tlb->num_entries = entries;
+    tlb->ways = ways;
+    tlb->set_mask = entries / ways - 1;
+    tlb->policy = policy;
+    tlb->random_state = 1;
+
+    tlb->entries = (TlbEntry *)malloc(entries * sizeof(TlbEntry));
+    tlb->fifo_next = (unsigned *)calloc(entries / ways, sizeof(unsigned));
+    if (!tlb->entries || !tlb->fifo_next) {
+        fprintf(stderr, "Erro ao alocar memória para a TLB\n");
+        exit(EXIT_FAILURE);
+    }
+    for (unsigned i = 0; i < entries; i++) {
+        tlb->entries[i].frame = -1;
+    }
+}
+
+void tlb_free(Tlb *tlb) {
+    free(tlb->entries);
+    free(tlb->fifo_next);
+    tlb->entries = NULL;
+    tlb->fifo_next = NULL;
+}
+
+// Gerador próprio (xorshift) para não consumir a sequência da política random das páginas
+static uint32_t tlb_random(Tlb *tlb) {
+    uint32_t x = tlb->random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    tlb->random_state = x;
+    return x;
+}
+
+TlbEntry *tlb_insert(Tlb *tlb, uint64_t page, int frame, uint32_t bits) {
+
+    unsigned set_index = page & tlb->set_mask;
+    TlbEntry *set = &tlb->entries[set_index * tlb->ways];
+    unsigned victim = 0;
+
+    // Uma entrada livre do conjunto, se houver; senão a vítima da política
+    unsigned way;
+    for (way = 0; way < tlb->ways && set[way].frame >= 0; way++) {
+    }
+
+    if (way < tlb->ways) {
+        victim = way;
+    } else if (tlb->policy == TLB_LRU) {
+        for (way = 1; way < tlb->ways; way++) {
+            // Comparação relativa, que continua certa quando o relógio dá a volta
+            if ((int32_t)(set[way].stamp - set[victim].stamp) < 0) {
+                victim = way;
+            }
+        }
+    } else if (tlb->policy == TLB_FIFO) {
+        victim = tlb->fifo_next[set_index];
+        tlb->fifo_next[set_index] = (victim + 1) % tlb->ways;
+    } else {
+        victim = tlb_random(tlb) % tlb->ways;
+    }
+
+    set[victim].page = page;
+    set[victim].frame = frame;
+    set[victim].stamp = ++tlb->clock;
+    set[victim].bits = bits;
+    return &set[victim];
+}
+
+void tlb_invalidate(Tlb *tlb, uint64_t page) {
+
+    TlbEntry *set = &tlb->entries[(page & tlb->set_mask) * tlb->ways];
+    for (unsigned way = 0; way < tlb->ways; way++) {
+        if (set[way].page == page && set[way].frame >= 0) {
+            set[way].frame = -1;
+            tlb->shootdowns++;
+            return;
+        }
+    }
+}
+
+void tlb_print_stats(const Tlb *tlb) {
+
+    if (tlb->num_entries == 0) {
+        return;
+    }
+    printf("TLB: %u entradas, %u vias, substituicao %s\n", tlb->num_entries, tlb->ways, tlb_policy_name(tlb->policy));
+    printf("Taxa de acertos da TLB: %.2f%% (%lu percursos da tabela evitados)\n",
+           tlb->lookups ? 100.0 * tlb->hits / tlb->lookups : 0.0, tlb->hits);
+    printf("Invalidacoes da TLB (shootdowns): %lu\n", tlb->shootdowns);
+}
@@ -0,0 +1,87 @@
+#ifndef TLB_H
+#define TLB_H
+
+#include <stdint.h>
+
+// TLB associativa por conjuntos, compartilhada pelas quatro tabelas de páginas.
+// Fica na frente da tabela: num acerto o simulador usa o quadro guardado e não percorre a tabela.
+// Quem despeja uma página precisa invalidar a entrada dela (tlb_invalidate, o "shootdown"),
+// então a TLB nunca devolve uma tradução que a tabela já não tem.
+// Com entries == ways a TLB é totalmente associativa; o número de conjuntos é potência de 2
+
+enum { TLB_LRU, TLB_FIFO, TLB_RANDOM, NUM_TLB_POLICIES };
+
+typedef struct {
+    uint64_t page;      // número da página virtual
+    int32_t frame;      // -1 = entrada livre
+    uint32_t stamp;     // último uso, para o LRU
+    uint32_t bits;      // bits da PTE que a entrada já sabe estarem ligados (referenciada/suja)
+} TlbEntry;
+
+typedef struct {
+    TlbEntry *entries;      // num_sets conjuntos de ways entradas consecutivas
+    unsigned *fifo_next;    // próxima vítima de cada conjunto no FIFO
+    unsigned num_entries;
+    unsigned ways;
+    unsigned set_mask;
+    int policy;
+    uint32_t clock;
+    uint32_t random_state;
+
+    unsigned long lookups;
+    unsigned long hits;
+    unsigned long shootdowns;
+} Tlb;
+
+// Lê "entradas[/vias[/politica]]" (ex.: 64/4/lru). Sem vias a TLB é totalmente associativa e a
+// política padrão é lru. Retorna 0 ou -1, com a mensagem de erro já impressa
+int tlb_parse_spec(const char *spec, unsigned *entries, unsigned *ways, int *policy);
+
+// entries == 0 deixa a TLB desligada
+void tlb_init(Tlb *tlb, unsigned entries, unsigned ways, int policy);
+
+// Libera as entradas; as estatísticas continuam disponíveis para o relatório
+void tlb_free(Tlb *tlb);
+
+// Guarda a tradução page -> frame, escolhendo a vítima do conjunto se ele estiver cheio.
+// Devolve a entrada usada
+TlbEntry *tlb_insert(Tlb *tlb, uint64_t page, int frame, uint32_t bits);
+
+// Invalida a tradução da página, se ela estiver na TLB
+void tlb_invalidate(Tlb *tlb, uint64_t page);
+
+const char *tlb_policy_name(int policy);
+
+// Configuração, taxa de acertos e percursos evitados; não imprime nada com a TLB desligada
+void tlb_print_stats(const Tlb *tlb);
+
+static inline int tlb_enabled(const Tlb *tlb) {
+    return tlb->entries != NULL;
+}
+
+// Entrada com a tradução da página, ou NULL numa falta de TLB
+static inline TlbEntry *tlb_lookup(Tlb *tlb, uint64_t page) {
+
+    TlbEntry *set = &tlb->entries[(page & tlb->set_mask) * tlb->ways];
+    tlb->lookups++;
+
+    for (unsigned way = 0; way < tlb->ways; way++) {
+        if (set[way].page == page && set[way].frame >= 0) {
+            tlb->hits++;
+            set[way].stamp = ++tlb->clock;
+            return &set[way];
+        }
+    }
+    return NULL;
+}
+
+// Conta count acertos seguidos na entrada, com o mesmo efeito de count chamadas de tlb_lookup
+// que a encontram (usado quando vários acessos seguidos caem na mesma página)
+static inline void tlb_repeat_hits(Tlb *tlb, TlbEntry *entry, unsigned long count) {
+    tlb->lookups += count;
+    tlb->hits += count;
+    tlb->clock += count;
+    entry->stamp = tlb->clock;
+}
+
+#endif
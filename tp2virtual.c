@@ -12,7 +12,7 @@ int main(int argc, char *argv[]) {
     // gettimeofday(&start, NULL);
 
     if (argc != 6) {
-        fprintf(stderr, "Uso: tp2virtual <algoritmo> <arquivo.log> <tamanho_pagina_kb> <memoria_kb> <tipo_tabela>\n\nAs tabelas podem ser do tipo: dense, doisNiveis, tresNiveis ou inverted\n");
+        fprintf(stderr, "Uso: tp2virtual <algoritmo> <arquivo.log> <tamanho_pagina_kb> <memoria_kb> <tipo_tabela>\n\nAs tabelas podem ser do tipo: dense, doisNiveis, tresNiveis, quatroNiveis ou inverted\n");
         exit(EXIT_FAILURE);
     }
 
@@ -51,12 +51,16 @@ int main(int argc, char *argv[]) {
 
         sprintf(command, "./tresNiveis %s %s %s %s", arg1, arg2, arg3, arg4);
 
+    } else if (strcmp(table_type, "quatroNiveis") == 0) {
+
+        sprintf(command, "./quatroNiveis %s %s %s %s", arg1, arg2, arg3, arg4);
+
     } else if (strcmp(table_type, "inverted") == 0) {
 
         sprintf(command, "./inverted %s %s %s %s", arg1, arg2, arg3, arg4);
 
     } else {
-        printf("Escolha uma tabela da lista: dense, doisNiveis, tresNiveis ou inverted\n\t\t\t : ( \n");
+        printf("Escolha uma tabela da lista: dense, doisNiveis, tresNiveis, quatroNiveis ou inverted\n\t\t\t : ( \n");
     }
 
     // printf("%s %s %s %s %s\n", arg1, table_type, arg2, arg3, arg4);
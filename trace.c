@@ -0,0 +1,708 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "stream.h"
+#include "trace.h"
+
+_Static_assert(sizeof(TraceHeader) == TRACE_HEADER_SIZE, "cabeçalho do trace deve ter 16 bytes");
+
+// Número máximo de avisos de linha mal formada impressos por trace
+#define MAX_MALFORMED_WARNINGS 10
+
+// Valor de cada dígito hexadecimal, -1 para os demais caracteres
+static const signed char hex_digit[256] = {
+    [0 ... 255] = -1,
+    ['0'] = 0, ['1'] = 1, ['2'] = 2, ['3'] = 3, ['4'] = 4,
+    ['5'] = 5, ['6'] = 6, ['7'] = 7, ['8'] = 8, ['9'] = 9,
+    ['a'] = 10, ['b'] = 11, ['c'] = 12, ['d'] = 13, ['e'] = 14, ['f'] = 15,
+    ['A'] = 10, ['B'] = 11, ['C'] = 12, ['D'] = 13, ['E'] = 14, ['F'] = 15,
+};
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Valida o cabeçalho de um trace binário
+static int trace_check_header(const TraceHeader *header) {
+
+    if (header->version != TRACE_VERSION) {
+        fprintf(stderr, "Versão de trace binário não suportada: %u\n", header->version);
+        return -1;
+    }
+
+    if (header->address_bits != 32 && header->address_bits != 64) {
+        fprintf(stderr, "Largura de endereço não suportada no trace binário: %u bits\n", header->address_bits);
+        return -1;
+    }
+    return 0;
+}
+
+// Mapeia um trace binário e valida o cabeçalho
+static int trace_open_binary(TraceReader *trace, int fd, size_t size) {
+
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        perror("Erro ao mapear o arquivo de trace");
+        return -1;
+    }
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    TraceHeader header;
+    memcpy(&header, map, sizeof(header));
+
+    if (trace_check_header(&header) != 0) {
+        munmap(map, size);
+        return -1;
+    }
+
+    if (header.record_count > (size - TRACE_HEADER_SIZE) / (header.address_bits / 8)) {
+        fprintf(stderr, "Trace binário truncado: %s\n", trace->path);
+        munmap(map, size);
+        return -1;
+    }
+
+    trace->format = TRACE_BINARY;
+    trace->address_bits = header.address_bits;
+    trace->map = map;
+    trace->map_size = size;
+    trace->records = (const uint32_t *)((const char *)map + TRACE_HEADER_SIZE);
+    trace->record_count = header.record_count;
+    trace->batch_count = header.record_count;
+    trace->position = 0;
+    return 0;
+}
+
+// Bytes da entrada sem mapeamento: primeiro o início guardado na detecção do formato, depois
+// a descompressão ou o próprio descritor
+static ssize_t trace_source_read(TraceReader *trace, void *buffer, size_t size) {
+    if (trace->prefix_pos < trace->prefix_len) {
+        size_t n = trace->prefix_len - trace->prefix_pos;
+        if (n > size) {
+            n = size;
+        }
+        memcpy(buffer, trace->prefix + trace->prefix_pos, n);
+        trace->prefix_pos += n;
+        return (ssize_t)n;
+    }
+    ssize_t n = trace->stream ? stream_read(trace->stream, buffer, size) : read(trace->fd, buffer, size);
+    if (n < 0) {
+        trace->failed = 1;
+    }
+    return n;
+}
+
+// Lê até size bytes, parando antes só no fim da entrada ou num erro
+static size_t trace_source_read_full(TraceReader *trace, void *buffer, size_t size) {
+    size_t total = 0;
+    while (total < size) {
+        ssize_t n = trace_source_read(trace, (char *)buffer + total, size - total);
+        if (n < 0 && !trace->stream) {
+            perror("Erro ao ler o arquivo de trace");
+        }
+        if (n <= 0) {
+            break;
+        }
+        total += n;
+    }
+    return total;
+}
+
+// Trace binário sem mapeamento, lido em lotes; o cabeçalho já está em prefix
+static int trace_open_binary_stream(TraceReader *trace) {
+
+    TraceHeader header;
+    memcpy(&header, trace->prefix, sizeof(header));
+    if (trace_check_header(&header) != 0) {
+        return -1;
+    }
+
+    trace->format = TRACE_BINARY_STREAM;
+    trace->address_bits = header.address_bits;
+    trace->prefix_pos = TRACE_HEADER_SIZE;
+    trace->records = trace->batch;
+    trace->record_count = header.record_count;
+    trace->batch_count = 0;
+    trace->position = 0;
+    return 0;
+}
+
+// Próximo lote de um trace binário sem mapeamento
+static int trace_refill_binary(TraceReader *trace) {
+
+    uint64_t remaining = trace->record_count - trace->parsed_records;
+    if (trace->eof || remaining == 0) {
+        return 0;
+    }
+
+    size_t record_size = trace->address_bits / 8;
+    size_t wanted = remaining < TRACE_BATCH_RECORDS ? (size_t)remaining : TRACE_BATCH_RECORDS;
+    size_t bytes = trace_source_read_full(trace, trace->batch, wanted * record_size);
+    size_t count = bytes / record_size;
+    if (count < wanted) {
+        fprintf(stderr, "Trace binário truncado: %s\n", trace->path);
+        trace->eof = 1;
+        trace->failed = 1;
+    }
+
+    trace->parsed_bytes += bytes;
+    trace->parsed_records += count;
+    trace->batch_count = count;
+    trace->position = 0;
+    return count > 0;
+}
+
+// Prepara a leitura de um trace texto: mapeia o arquivo inteiro quando possível (st de um
+// arquivo regular), senão lê em blocos de TRACE_BLOCK_SIZE
+static int trace_open_text(TraceReader *trace, int fd, const struct stat *st) {
+
+    trace->format = TRACE_TEXT;
+    trace->address_bits = 32;
+    trace->records = trace->batch;
+
+    if (st && S_ISREG(st->st_mode) && st->st_size > 0) {
+        void *map = mmap(NULL, (size_t)st->st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            madvise(map, (size_t)st->st_size, MADV_SEQUENTIAL);
+            trace->map = map;
+            trace->map_size = (size_t)st->st_size;
+            trace->cursor = (const char *)map;
+            trace->parse_end = trace->cursor + st->st_size;
+            trace->text_end = trace->parse_end;
+            trace->eof = 1;
+            return 0;
+        }
+    }
+
+    trace->block = (char *)malloc(TRACE_BLOCK_SIZE);
+    if (!trace->block) {
+        fprintf(stderr, "Erro ao alocar o buffer de leitura do trace\n");
+        return -1;
+    }
+    trace->fd = fd;
+    trace->cursor = trace->block;
+    trace->parse_end = trace->block;
+    trace->text_end = trace->block;
+    return 0;
+}
+
+static int is_binary_header(const unsigned char *bytes, size_t len) {
+    return len == TRACE_HEADER_SIZE && memcmp(bytes, TRACE_MAGIC, 4) == 0;
+}
+
+// Trace comprimido: a thread de stream.h descomprime fd, e o formato (texto ou binário) é
+// reconhecido pelo início do conteúdo descomprimido
+static int trace_open_compressed(TraceReader *trace, int fd, int kind) {
+
+    trace->stream = (TraceStream *)malloc(sizeof(TraceStream));
+    if (!trace->stream) {
+        fprintf(stderr, "Erro ao alocar a descompressao do trace\n");
+        return -1;
+    }
+    // O início já lido de um pipe faz parte da entrada comprimida
+    if (stream_start(trace->stream, kind, fd, trace->prefix, trace->prefix_len) != 0) {
+        free(trace->stream);
+        trace->stream = NULL;
+        return -1;
+    }
+    trace->fd = fd;
+    trace->prefix_len = 0;
+
+    trace->prefix_len = trace_source_read_full(trace, trace->prefix, TRACE_HEADER_SIZE);
+    if (is_binary_header(trace->prefix, trace->prefix_len)) {
+        return trace_open_binary_stream(trace);
+    }
+    return trace_open_text(trace, fd, NULL);
+}
+
+int trace_open(TraceReader *trace, const char *path) {
+
+    memset(trace, 0, sizeof(*trace));
+    trace->path = path;
+    trace->fd = -1;
+
+    int fd = strcmp(path, "-") == 0 ? dup(STDIN_FILENO) : open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    // O início da entrada identifica a compressão e o formato. De um arquivo regular ele é lido
+    // sem consumir nada; de um pipe fica guardado em prefix para ser entregue antes do resto
+    int regular = S_ISREG(st.st_mode);
+    size_t magic_len;
+    if (regular) {
+        ssize_t n = pread(fd, trace->prefix, TRACE_HEADER_SIZE, 0);
+        magic_len = n > 0 ? (size_t)n : 0;
+    } else {
+        trace->fd = fd;
+        magic_len = trace_source_read_full(trace, trace->prefix, TRACE_HEADER_SIZE);
+        trace->prefix_len = magic_len;
+    }
+
+    int result;
+    int compression = stream_detect(trace->prefix, magic_len);
+    if (compression >= 0) {
+        result = trace_open_compressed(trace, fd, compression);
+    } else if (is_binary_header(trace->prefix, magic_len)) {
+        result = regular ? trace_open_binary(trace, fd, (size_t)st.st_size) : trace_open_binary_stream(trace);
+    } else {
+        result = trace_open_text(trace, fd, regular ? &st : NULL);
+    }
+
+    if (result != 0) {
+        int owned = trace->fd == fd;
+        trace_close(trace);
+        if (!owned) {
+            close(fd);
+        }
+        return result;
+    }
+
+    // Com o arquivo mapeado o descritor não é mais necessário
+    if (trace->fd != fd) {
+        close(fd);
+    }
+    return result;
+}
+
+void trace_close(TraceReader *trace) {
+    // A thread de descompressão lê o descritor, então para antes de ele ser fechado
+    if (trace->stream) {
+        stream_stop(trace->stream);
+        free(trace->stream);
+        trace->stream = NULL;
+    }
+    if (trace->map) {
+        munmap(trace->map, trace->map_size);
+        trace->map = NULL;
+    }
+    if (trace->fd >= 0) {
+        close(trace->fd);
+        trace->fd = -1;
+    }
+    free(trace->block);
+    trace->block = NULL;
+    free(trace->owned);
+    trace->owned = NULL;
+}
+
+// Junta num vetor próprio o resto do lote atual e todos os lotes seguintes, na largura final do
+// trace: se ele passar a 64 bits no meio, os registros de 32 já juntados são alargados.
+// Devolve o vetor e a contagem em *count_out, ou NULL se faltou memória
+static void *trace_collect(TraceReader *trace, size_t *count_out) {
+
+    unsigned bits = trace->address_bits;
+    size_t count = 0;
+    size_t capacity = (size_t)TRACE_BATCH_RECORDS * 256;
+    char *owned = (char *)malloc(capacity * (bits / 8));
+    size_t first = trace->position;     // o lote atual pode já ter sido começado
+
+    while (owned) {
+        if (trace->address_bits != bits) {
+            // Do fim para o começo, para o registro alargado não cobrir um que ainda não foi lido
+            char *grown = (char *)realloc(owned, capacity * sizeof(uint64_t));
+            if (!grown) {
+                free(owned);
+                owned = NULL;
+                break;
+            }
+            owned = grown;
+            for (size_t i = count; i-- > 0;) {
+                ((uint64_t *)owned)[i] = ((uint32_t *)owned)[i];
+            }
+            bits = trace->address_bits;
+        }
+
+        size_t size = bits / 8;
+        size_t n = trace->batch_count - first;
+        if (count + n > capacity) {
+            while (count + n > capacity) {
+                capacity *= 2;
+            }
+            char *grown = (char *)realloc(owned, capacity * size);
+            if (!grown) {
+                free(owned);
+                owned = NULL;
+                break;
+            }
+            owned = grown;
+        }
+        memcpy(owned + count * size, (const char *)trace->records + first * size, n * size);
+        count += n;
+        first = 0;
+
+        if (!trace_refill(trace)) {
+            *count_out = count;
+            return owned;
+        }
+    }
+
+    fprintf(stderr, "Erro ao alocar memória para o trace %s\n", trace->path);
+    return NULL;
+}
+
+int trace_load(TraceBuffer *buffer, const char *path) {
+
+    memset(buffer, 0, sizeof(*buffer));
+    buffer->path = path;
+
+    if (trace_open(&buffer->source, path) != 0) {
+        return -1;
+    }
+
+    if (buffer->source.format == TRACE_BINARY) {
+        buffer->address_bits = buffer->source.address_bits;
+        buffer->records = buffer->source.records;
+        buffer->count = buffer->source.record_count;
+        return 0;
+    }
+
+    buffer->owned = trace_collect(&buffer->source, &buffer->count);
+    if (!buffer->owned || buffer->source.failed) {
+        trace_buffer_free(buffer);
+        return -1;
+    }
+
+    // Os registros já foram copiados; o arquivo pode ser fechado mantendo as estatísticas
+    buffer->address_bits = buffer->source.address_bits;
+    trace_close(&buffer->source);
+    buffer->records = buffer->owned;
+    return 0;
+}
+
+void trace_buffer_free(TraceBuffer *buffer) {
+    trace_close(&buffer->source);
+    free(buffer->owned);
+    buffer->owned = NULL;
+    buffer->records = NULL;
+    buffer->count = 0;
+}
+
+void trace_open_buffer(TraceReader *trace, const TraceBuffer *buffer) {
+    memset(trace, 0, sizeof(*trace));
+    trace->format = TRACE_BINARY;
+    trace->path = buffer->path;
+    trace->fd = -1;
+    trace->address_bits = buffer->address_bits;
+    trace->records = buffer->records;
+    trace->record_count = buffer->count;
+    trace->batch_count = buffer->count;
+}
+
+int trace_make_resident(TraceReader *trace) {
+
+    if (trace->format == TRACE_BINARY || trace->owned) {
+        return 0;
+    }
+
+    size_t count;
+    void *owned = trace_collect(trace, &count);
+    if (!owned || trace->failed) {
+        free(owned);
+        return -1;
+    }
+
+    trace->owned = owned;
+    trace->records = owned;
+    trace->batch_count = count;
+    trace->position = 0;
+    return 0;
+}
+
+long trace_number_pages(const uint64_t *records, size_t count, unsigned page_shift, uint32_t *ids) {
+
+    // Endereçamento aberto com a página + 1 como chave (0 = posição vazia), com no máximo metade cheia
+    size_t capacity = 1024;
+    uint64_t *keys = (uint64_t *)calloc(capacity, sizeof(uint64_t));
+    uint32_t *values = (uint32_t *)malloc(capacity * sizeof(uint32_t));
+    long distinct = 0;
+
+    for (size_t i = 0; i < count && keys && values; i++) {
+        if ((size_t)distinct * 2 >= capacity) {
+            // Dobra a tabela e reinsere as chaves
+            size_t grown_capacity = capacity * 2;
+            uint64_t *grown_keys = (uint64_t *)calloc(grown_capacity, sizeof(uint64_t));
+            uint32_t *grown_values = (uint32_t *)malloc(grown_capacity * sizeof(uint32_t));
+            if (!grown_keys || !grown_values) {
+                free(grown_keys);
+                free(grown_values);
+                free(keys);
+                keys = NULL;
+                break;
+            }
+            for (size_t j = 0; j < capacity; j++) {
+                if (keys[j]) {
+                    size_t slot = (keys[j] * 0x9E3779B97F4A7C15ull) >> 32 & (grown_capacity - 1);
+                    while (grown_keys[slot]) {
+                        slot = (slot + 1) & (grown_capacity - 1);
+                    }
+                    grown_keys[slot] = keys[j];
+                    grown_values[slot] = values[j];
+                }
+            }
+            free(keys);
+            free(values);
+            keys = grown_keys;
+            values = grown_values;
+            capacity = grown_capacity;
+        }
+
+        uint64_t key = (records[i] >> page_shift) + 1;
+        size_t slot = (key * 0x9E3779B97F4A7C15ull) >> 32 & (capacity - 1);
+        while (keys[slot] && keys[slot] != key) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        if (!keys[slot]) {
+            keys[slot] = key;
+            values[slot] = (uint32_t)distinct++;
+        }
+        ids[i] = values[slot];
+    }
+
+    if (!keys || !values) {
+        fprintf(stderr, "Erro ao alocar memória para numerar as páginas do trace\n");
+        distinct = -1;
+    }
+    free(keys);
+    free(values);
+    return distinct;
+}
+
+// Lê mais um bloco do arquivo, preservando a linha incompleta do fim do bloco anterior
+static int trace_read_block(TraceReader *trace) {
+
+    if (trace->eof) {
+        return 0;
+    }
+
+    size_t pending = trace->text_end - trace->cursor;
+    memmove(trace->block, trace->cursor, pending);
+    trace->cursor = trace->block;
+    trace->text_end = trace->block + pending;
+
+    while (trace->text_end < trace->block + TRACE_BLOCK_SIZE) {
+        ssize_t n = trace_source_read(trace, (char *)trace->text_end, trace->block + TRACE_BLOCK_SIZE - trace->text_end);
+        if (n < 0) {
+            // Os erros da descompressão já foram informados pela thread
+            if (!trace->stream) {
+                perror("Erro ao ler o arquivo de trace");
+            }
+            trace->eof = 1;
+            break;
+        }
+        if (n == 0) {
+            trace->eof = 1;
+            break;
+        }
+        trace->text_end += n;
+    }
+
+    if (trace->eof) {
+        trace->parse_end = trace->text_end;
+        return trace->text_end > trace->cursor;
+    }
+
+    const char *last_newline = memrchr(trace->cursor, '\n', trace->text_end - trace->cursor);
+    if (!last_newline) {
+        // Linha maior que o bloco inteiro: descarta até encontrar o fim dela
+        trace->skipping_line = 1;
+        trace->cursor = trace->text_end;
+        trace->parse_end = trace->text_end;
+        return 1;
+    }
+    trace->parse_end = last_newline + 1;
+    return 1;
+}
+
+static void trace_report_malformed(TraceReader *trace) {
+    trace->malformed_lines++;
+    if (trace->malformed_lines <= MAX_MALFORMED_WARNINGS) {
+        fprintf(stderr, "Aviso: linha %lu mal formada em %s ignorada\n", trace->line_number, trace->path);
+    }
+}
+
+static inline int is_blank(unsigned char c) {
+    return c == ' ' || c == '\t';
+}
+
+// Decodifica uma linha "<endereco_hex> <R|W>" terminada em \n ou \r\n.
+// Retorna 1 se gerou um registro, 0 para linha vazia e -1 para linha mal formada.
+// O cursor sempre avança até depois do fim da linha
+static inline int trace_parse_line(const char **cursor, const char *end, uint64_t *record) {
+
+    const unsigned char *p = (const unsigned char *)*cursor;
+    const unsigned char *e = (const unsigned char *)end;
+
+    while (p < e && is_blank(*p)) {
+        p++;
+    }
+    if (p == e || *p == '\n' || *p == '\r') {
+        while (p < e && *p != '\n') {
+            p++;
+        }
+        *cursor = (const char *)(p < e ? p + 1 : p);
+        return 0;
+    }
+
+    if (e - p > 2 && p[0] == '0' && (p[1] | 0x20) == 'x') {
+        p += 2;
+    }
+
+    uint64_t addr = 0;
+    const unsigned char *digits = p;
+    while (p < e && hex_digit[*p] >= 0) {
+        if (addr >> 60) {
+            goto malformed;
+        }
+        addr = (addr << 4) | (uint64_t)hex_digit[*p];
+        p++;
+    }
+    if (p == digits || p == e || !is_blank(*p)) {
+        goto malformed;
+    }
+
+    while (p < e && is_blank(*p)) {
+        p++;
+    }
+    if (p == e) {
+        goto malformed;
+    }
+
+    uint64_t write_bit;
+    switch (*p++) {
+        case 'W': case 'w': write_bit = TRACE_WRITE_BIT; break;
+        case 'R': case 'r': write_bit = 0; break;
+        default: goto malformed;
+    }
+
+    while (p < e && is_blank(*p)) {
+        p++;
+    }
+    if (p < e && *p == '\r') {
+        p++;
+    }
+    if (p < e) {
+        if (*p != '\n') {
+            goto malformed;
+        }
+        p++;
+    }
+
+    *cursor = (const char *)p;
+    *record = (addr & ~(uint64_t)TRACE_WRITE_BIT) | write_bit;
+    return 1;
+
+malformed:
+    p = memchr(p, '\n', e - p);
+    *cursor = p ? (const char *)p + 1 : end;
+    return -1;
+}
+
+// Primeiro endereço de mais de 32 bits de um trace texto: o trace passa a 64 bits, e os count
+// registros já decodificados no lote são alargados do fim para o começo, no mesmo lugar
+static void widen_batch(TraceReader *trace, size_t count) {
+    for (size_t i = count; i-- > 0;) {
+        trace->batch64[i] = trace->batch[i];
+    }
+    trace->address_bits = 64;
+    trace->records64 = trace->batch64;
+}
+
+int trace_refill(TraceReader *trace) {
+
+    if (trace->format == TRACE_BINARY || trace->owned) {
+        return 0;
+    }
+    if (trace->format == TRACE_BINARY_STREAM) {
+        return trace_refill_binary(trace);
+    }
+
+    double start = now_seconds();
+    size_t count = 0;
+
+    while (count < TRACE_BATCH_RECORDS) {
+
+        if (trace->cursor == trace->parse_end) {
+            if (!trace_read_block(trace)) {
+                if (trace->skipping_line) {
+                    trace->skipping_line = 0;
+                    trace->line_number++;
+                    trace_report_malformed(trace);
+                }
+                break;
+            }
+        }
+
+        if (trace->skipping_line) {
+            // Resto da linha longa demais: pula até a próxima quebra de linha
+            const char *newline = memchr(trace->cursor, '\n', trace->parse_end - trace->cursor);
+            trace->cursor = newline ? newline + 1 : trace->parse_end;
+            if (newline) {
+                trace->skipping_line = 0;
+                trace->line_number++;
+                trace_report_malformed(trace);
+            }
+            continue;
+        }
+
+        const char *line = trace->cursor;
+        uint64_t record;
+        trace->line_number++;
+        int result = trace_parse_line(&trace->cursor, trace->parse_end, &record);
+        trace->parsed_bytes += trace->cursor - line;
+
+        if (result > 0) {
+            if (trace->address_bits == 32 && (record >> 32) != 0) {
+                widen_batch(trace, count);
+            }
+            if (trace->address_bits == 64) {
+                trace->batch64[count++] = record;
+            } else {
+                trace->batch[count++] = (uint32_t)record;
+            }
+        } else if (result < 0) {
+            trace_report_malformed(trace);
+        }
+    }
+
+    trace->parse_seconds += now_seconds() - start;
+    trace->parsed_records += count;
+    trace->batch_count = count;
+    trace->position = 0;
+    return count > 0;
+}
+
+void trace_print_stats(const TraceReader *trace) {
+
+    if (trace->stream) {
+        const TraceStream *stream = trace->stream;
+        printf("Descompressao %s em thread propria: %.1f MB -> %.1f MB; simulacao esperou %.3f s, descompressao esperou %.3f s\n",
+               stream_kind_name(stream->kind), stream->bytes_in / 1e6, stream->bytes_out / 1e6,
+               stream->consumer_wait_seconds, stream->producer_wait_seconds);
+    }
+
+    if (trace->format != TRACE_TEXT) {
+        return;
+    }
+
+    double seconds = trace->parse_seconds > 0 ? trace->parse_seconds : 1e-9;
+    printf("Vazao do parser: %.1f MB/s (%.2f milhoes de acessos/s)\n",
+           trace->parsed_bytes / seconds / 1e6, trace->parsed_records / seconds / 1e6);
+    if (trace->malformed_lines > 0) {
+        printf("Linhas mal formadas ignoradas: %lu\n", trace->malformed_lines);
+    }
+}
@@ -0,0 +1,200 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Formato binário de trace (.bin), gerado pelo trace2bin
+//
+// Cabeçalho de 16 bytes (little-endian):
+//   magic[4]      "VMTB"
+//   version       uint16
+//   address_bits  uint16 (largura dos endereços; define o tamanho do registro)
+//   record_count  uint64
+// Seguido de record_count registros de address_bits / 8 bytes (32 ou 64), alinhados ao seu tamanho.
+// O bit 0 de cada registro guarda o tipo de acesso (1 = escrita). Como a menor
+// página simulada tem 2 KB, esse bit do deslocamento nunca chega à simulação.
+#define TRACE_MAGIC "VMTB"
+#define TRACE_VERSION 1
+#define TRACE_HEADER_SIZE 16
+#define TRACE_WRITE_BIT 1u
+
+// Traces texto são decodificados em lotes de registros no mesmo formato do binário
+#define TRACE_BATCH_RECORDS 4096
+// Tamanho do bloco de leitura quando o arquivo texto não pode ser mapeado
+#define TRACE_BLOCK_SIZE (1 << 20)
+
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t address_bits;
+    uint64_t record_count;
+} TraceHeader;
+
+// TRACE_BINARY_STREAM é um trace binário que não pode ser mapeado (entrada padrão, pipe ou
+// comprimido), lido em lotes como o texto
+enum { TRACE_TEXT, TRACE_BINARY, TRACE_BINARY_STREAM };
+
+// Leitor de trace: arquivos binários são mapeados em memória e consumidos direto;
+// arquivos texto ("<endereco_hex> <R|W>" por linha) são mapeados (ou lidos em blocos)
+// e decodificados em lotes por um parser próprio. O caminho "-" é a entrada padrão, e traces
+// comprimidos com gzip ou xz (de qualquer formato) são descomprimidos em fluxo por uma thread
+// (stream.h), sem passar pelo disco.
+// Os registros têm 32 ou 64 bits (address_bits). Um trace texto começa com 32 e passa a 64 no
+// primeiro endereço que não cabe, convertendo o lote em que ele aparece; os traces de 32 bits
+// continuam sendo lidos como sempre
+typedef struct {
+    int format;
+    const char *path;
+    int fd;
+    unsigned address_bits;
+
+    // Registros prontos para consumo: o arquivo todo (binário) ou o lote atual (texto),
+    // em records ou records64 conforme address_bits
+    union {
+        const uint32_t *records;
+        const uint64_t *records64;
+    };
+    size_t batch_count;
+    size_t position;
+
+    // Região mapeada (binário ou texto)
+    void *map;
+    size_t map_size;
+    uint64_t record_count;
+
+    // Entrada sem mapeamento: início já lido para detectar o formato, entregue antes do resto,
+    // e a descompressão, quando houver
+    unsigned char prefix[TRACE_HEADER_SIZE];
+    size_t prefix_len;
+    size_t prefix_pos;
+    struct TraceStream *stream;
+
+    // Formato texto
+    const char *cursor;     // próximo byte a decodificar
+    const char *parse_end;  // fim da última linha completa disponível
+    const char *text_end;   // fim dos dados disponíveis
+    char *block;            // buffer de leitura quando não há mapeamento
+    int eof;
+    int failed;             // erro de leitura ou trace truncado: os acessos acabaram antes do fim do trace
+    int skipping_line;      // descartando o resto de uma linha maior que o bloco
+    union {
+        uint32_t batch[TRACE_BATCH_RECORDS];
+        uint64_t batch64[TRACE_BATCH_RECORDS];
+    };
+    void *owned;            // resto do trace texto decodificado de uma vez (trace_make_resident)
+
+    // Estatísticas do parser
+    unsigned long line_number;
+    unsigned long malformed_lines;
+    uint64_t parsed_bytes;
+    uint64_t parsed_records;
+    double parse_seconds;
+} TraceReader;
+
+// Trace carregado inteiro em memória, para ser simulado várias vezes sem reler o arquivo
+typedef struct {
+    const char *path;
+    unsigned address_bits;
+    union {
+        const uint32_t *records;
+        const uint64_t *records64;
+    };
+    size_t count;
+    void *owned;          // registros decodificados de um trace texto
+    TraceReader source;   // mantém o mapeamento de um trace binário e as estatísticas do parser
+} TraceBuffer;
+
+// Abre o trace ("-" para a entrada padrão) detectando a compressão e o formato pelo cabeçalho.
+// Retorna 0 em caso de sucesso
+int trace_open(TraceReader *trace, const char *path);
+
+// Carrega o trace em memória: binários ficam mapeados, textos são decodificados uma única vez.
+// Um trace truncado ou ilegível é recusado inteiro
+int trace_load(TraceBuffer *buffer, const char *path);
+
+void trace_buffer_free(TraceBuffer *buffer);
+
+// Abre um leitor sobre um trace já carregado; o leitor não precisa de trace_close
+void trace_open_buffer(TraceReader *trace, const TraceBuffer *buffer);
+
+void trace_close(TraceReader *trace);
+
+// Deixa todos os registros ainda não lidos em trace->records, como um único lote a partir da
+// posição 0, para quem precisa do trace inteiro antes de simular (a política opt). Binários
+// já estão mapeados; o resto de um trace texto é decodificado de uma vez. Retorna 0 em caso de sucesso
+// e -1 se faltou memória ou o trace estava truncado
+int trace_make_resident(TraceReader *trace);
+
+// Decodifica o próximo lote. Retorna 0 quando o trace acabou
+int trace_refill(TraceReader *trace);
+
+// Numera as páginas (registro >> page_shift) de count registros de 64 bits na ordem da primeira
+// aparição: ids[i] recebe o número da página do registro i, para quem indexa vetores por página
+// (opt, mrc) sem uma tabela do tamanho do espaço de endereços. Retorna quantas páginas
+// distintas há, ou -1 se faltou memória
+long trace_number_pages(const uint64_t *records, size_t count, unsigned page_shift, uint32_t *ids);
+
+// Registro i de records, de 32 ou 64 bits, para as passadas sobre o trace inteiro
+static inline uint64_t trace_record(const TraceReader *trace, size_t i) {
+    return trace->address_bits == 64 ? trace->records64[i] : trace->records[i];
+}
+
+// Imprime a vazão do parser texto, o número de linhas mal formadas ignoradas e, para traces
+// comprimidos, quanto a simulação e a descompressão esperaram uma pela outra
+void trace_print_stats(const TraceReader *trace);
+
+// Lê o próximo acesso. Retorna 1 enquanto houver acessos e 0 no fim do trace
+static inline int trace_next(TraceReader *trace, uint64_t *addr, char *rw) {
+    if (trace->position == trace->batch_count) {
+        if (!trace_refill(trace)) {
+            return 0;
+        }
+    }
+    uint64_t record = trace_record(trace, trace->position++);
+    *addr = record & ~(uint64_t)TRACE_WRITE_BIT;
+    *rw = (record & TRACE_WRITE_BIT) ? 'W' : 'R';
+    return 1;
+}
+
+// Lê o próximo acesso como trace_next e consome também até max_repeats acessos seguintes à mesma
+// página (endereço >> page_shift): *repeats recebe quantos foram e *repeats_written diz se algum
+// deles é escrita. A sequência só é procurada no lote atual, então pode chegar dividida em duas;
+// quem depende do instante exato de cada acesso (o limpador) a corta com max_repeats
+static inline int trace_next_run(TraceReader *trace, unsigned page_shift, uint64_t *addr, char *rw,
+                                 unsigned long max_repeats, unsigned long *repeats, int *repeats_written) {
+    if (!trace_next(trace, addr, rw)) {
+        return 0;
+    }
+
+    size_t position = trace->position;
+    size_t end = trace->batch_count;
+    if (max_repeats < end - position) {
+        end = position + max_repeats;
+    }
+    uint64_t written = 0;
+
+    if (trace->address_bits == 64) {
+        const uint64_t *records = trace->records64;
+        uint64_t page = *addr >> page_shift;
+        while (position < end && (records[position] >> page_shift) == page) {
+            written |= records[position];
+            position++;
+        }
+    } else {
+        const uint32_t *records = trace->records;
+        uint32_t page = (uint32_t)*addr >> page_shift;
+        while (position < end && (records[position] >> page_shift) == page) {
+            written |= records[position];
+            position++;
+        }
+    }
+
+    *repeats = position - trace->position;
+    *repeats_written = (written & TRACE_WRITE_BIT) != 0;
+    trace->position = position;
+    return 1;
+}
+
+#endif
@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "trace.h"
+
+// Grava count registros na largura da saída
+static void write_records(FILE *output, const uint64_t *records, size_t count, unsigned bits) {
+    if (bits == 64) {
+        fwrite(records, sizeof(uint64_t), count, output);
+        return;
+    }
+    uint32_t narrow[4096];
+    for (size_t i = 0; i < count; i++) {
+        narrow[i] = (uint32_t)records[i];
+    }
+    fwrite(narrow, sizeof(uint32_t), count, output);
+}
+
+// Alarga para 64 bits os count registros de 32 já gravados, em blocos do fim para o começo, para
+// um bloco alargado não cobrir registros que ainda não foram lidos. Retorna 0 em caso de sucesso
+static int widen_output(FILE *output, uint64_t count) {
+
+    uint32_t narrow[4096];
+    uint64_t wide[4096];
+    uint64_t end = count;
+    while (end > 0) {
+        size_t n = end < 4096 ? (size_t)end : 4096;
+        uint64_t first = end - n;
+        if (fseek(output, (long)(TRACE_HEADER_SIZE + first * sizeof(uint32_t)), SEEK_SET) != 0 ||
+            fread(narrow, sizeof(uint32_t), n, output) != n) {
+            return -1;
+        }
+        for (size_t i = 0; i < n; i++) {
+            wide[i] = narrow[i];
+        }
+        if (fseek(output, (long)(TRACE_HEADER_SIZE + first * sizeof(uint64_t)), SEEK_SET) != 0 ||
+            fwrite(wide, sizeof(uint64_t), n, output) != n) {
+            return -1;
+        }
+        end = first;
+    }
+    return fseek(output, (long)(TRACE_HEADER_SIZE + count * sizeof(uint64_t)), SEEK_SET);
+}
+
+// Converte um trace texto ("<endereco_hex> <R|W>" por linha) para o formato binário descrito em trace.h.
+// Os registros têm 32 bits enquanto os endereços couberem; no primeiro que não cabe, o que já foi
+// gravado é alargado e o resto sai com 64
+int main(int argc, char *argv[]) {
+
+    if (argc != 3) {
+        fprintf(stderr, "Uso: %s <arquivo.log> <arquivo.bin>\n", argv[0]);
+        return 1;
+    }
+
+    TraceReader input;
+    if (trace_open(&input, argv[1]) != 0) {
+        fprintf(stderr, "Erro ao abrir o arquivo %s.\n", argv[1]);
+        return 1;
+    }
+
+    // Aberta também para leitura, para o alargamento reler o que já foi gravado
+    FILE *output = fopen(argv[2], "w+b");
+    if (!output) {
+        perror("Erro ao criar o arquivo de saída");
+        trace_close(&input);
+        return 1;
+    }
+
+    // O número de registros e a largura só são conhecidos no fim, então o cabeçalho é reescrito depois
+    TraceHeader header;
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    header.address_bits = 32;
+    header.record_count = 0;
+    fwrite(&header, sizeof(header), 1, output);
+
+    uint64_t addr;
+    char rw;
+    uint64_t buffer[4096];
+    size_t buffered = 0;
+
+    while (trace_next(&input, &addr, &rw)) {
+        uint64_t record = addr | (rw == 'W' ? TRACE_WRITE_BIT : 0);
+        if (header.address_bits == 32 && (record >> 32) != 0) {
+            write_records(output, buffer, buffered, 32);
+            buffered = 0;
+            if (widen_output(output, header.record_count) != 0) {
+                perror("Erro ao alargar os registros já gravados");
+                fclose(output);
+                trace_close(&input);
+                return 1;
+            }
+            header.address_bits = 64;
+        }
+        buffer[buffered++] = record;
+        header.record_count++;
+
+        if (buffered == sizeof(buffer) / sizeof(buffer[0])) {
+            write_records(output, buffer, buffered, header.address_bits);
+            buffered = 0;
+        }
+    }
+    write_records(output, buffer, buffered, header.address_bits);
+
+    fseek(output, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, output);
+
+    if (fclose(output) != 0) {
+        perror("Erro ao gravar o arquivo de saída");
+        trace_close(&input);
+        return 1;
+    }
+    // Um trace de entrada truncado ou ilegível não vira um binário válido com parte dos acessos
+    if (input.failed) {
+        fprintf(stderr, "Trace de entrada incompleto: %s não foi gravado\n", argv[2]);
+        remove(argv[2]);
+        trace_close(&input);
+        return 1;
+    }
+
+    printf("Registros convertidos: %llu (%u bits)\n", (unsigned long long)header.record_count, header.address_bits);
+    trace_print_stats(&input);
+    trace_close(&input);
+    return 0;
+}
@@ -0,0 +1,333 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "trace.h"
+
+// Gerador de traces sintéticos, para ter cargas reproduzíveis sem os traces externos do teste.c.
+// Grava no formato binário de trace.h, ou no formato texto se o arquivo terminar em .log; os
+// registros binários têm 64 bits quando a região passa dos 4 GB (por exemplo com -b 7f0000000000,
+// como o heap de um processo x86-64). A mesma semente gera sempre o mesmo trace. Padrões:
+//   seq      percorre a região em passos de uma linha de cache, voltando ao início no fim
+//   stride   percorre a região em passos de -S bytes (padrão: uma página de 4 KB)
+//   uniform  endereços sorteados uniformemente na região
+//   zipf     páginas de 4 KB da região sorteadas com popularidade Zipf (expoente -z), espalhadas
+//            pela região para as mais acessadas não ficarem vizinhas
+//   loop     varre em laço um trecho de -l KB, pensado para ser maior que a memória simulada
+//   phases   o trace é dividido em -P fases; cada uma acessa com Zipf o próprio conjunto de
+//            trabalho de -l KB, então a memória inteira troca de uma fase para a outra
+
+#define BASE_ADDRESS 0x10000000ull
+#define ZIPF_PAGE_SIZE 4096u
+#define LINE_SIZE 64u
+
+enum { PATTERN_SEQ, PATTERN_STRIDE, PATTERN_UNIFORM, PATTERN_ZIPF, PATTERN_LOOP, PATTERN_PHASES };
+
+static const char *pattern_names[] = {"seq", "stride", "uniform", "zipf", "loop", "phases"};
+
+#define NUM_PATTERNS (sizeof(pattern_names) / sizeof(pattern_names[0]))
+
+typedef struct {
+    int pattern;
+    unsigned long accesses;
+    double write_ratio;
+    uint64_t seed;
+    unsigned long region_kb;    // região acessada por seq, stride, uniform e zipf
+    unsigned long stride;       // bytes
+    double zipf_exponent;
+    unsigned long loop_kb;      // trecho do loop e conjunto de trabalho de cada fase
+    unsigned phases;
+    uint64_t base;              // primeiro endereço da região
+} GeneratorConfig;
+
+// xorshift64*: rápido e com a mesma sequência em qualquer plataforma
+static uint64_t rng_state;
+
+static uint64_t rng_next() {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1Dull;
+}
+
+// Real uniforme em [0, 1)
+static double rng_uniform() {
+    return (rng_next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Distribuição Zipf sobre pages páginas: a acumulada, sorteada por busca binária, e uma
+// permutação multiplicativa que leva cada posto a uma página
+typedef struct {
+    double *cdf;
+    unsigned long pages;
+    unsigned long multiplier;   // primo com pages
+} Zipf;
+
+static unsigned long gcd(unsigned long a, unsigned long b) {
+    while (b) {
+        unsigned long t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static int zipf_init(Zipf *zipf, unsigned long pages, double exponent) {
+
+    zipf->pages = pages;
+    zipf->cdf = (double *)malloc(pages * sizeof(double));
+    if (!zipf->cdf) {
+        fprintf(stderr, "Erro ao alocar a distribuição Zipf de %lu páginas\n", pages);
+        return -1;
+    }
+
+    double sum = 0;
+    for (unsigned long rank = 0; rank < pages; rank++) {
+        sum += 1.0 / pow((double)(rank + 1), exponent);
+        zipf->cdf[rank] = sum;
+    }
+    for (unsigned long rank = 0; rank < pages; rank++) {
+        zipf->cdf[rank] /= sum;
+    }
+
+    zipf->multiplier = 2654435761ul % pages;
+    while (gcd(zipf->multiplier, pages) != 1) {
+        zipf->multiplier = (zipf->multiplier + 1) % pages;
+    }
+    return 0;
+}
+
+// Página sorteada, em [0, pages)
+static unsigned long zipf_next(const Zipf *zipf) {
+    double u = rng_uniform();
+    unsigned long low = 0, high = zipf->pages - 1;
+    while (low < high) {
+        unsigned long middle = (low + high) / 2;
+        if (zipf->cdf[middle] < u) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return (unsigned long)((uint64_t)low * zipf->multiplier % zipf->pages);
+}
+
+// Endereço de uma palavra sorteada dentro da página
+static uint64_t zipf_address(const Zipf *zipf, uint64_t base) {
+    uint64_t page = zipf_next(zipf);
+    return base + page * ZIPF_PAGE_SIZE + (rng_next() % (ZIPF_PAGE_SIZE / 4)) * 4;
+}
+
+// Grava count registros na largura do trace
+static void write_records(FILE *output, const uint64_t *records, size_t count, unsigned bits) {
+    if (bits == 64) {
+        fwrite(records, sizeof(uint64_t), count, output);
+        return;
+    }
+    uint32_t narrow[4096];
+    for (size_t i = 0; i < count; i++) {
+        narrow[i] = (uint32_t)records[i];
+    }
+    fwrite(narrow, sizeof(uint32_t), count, output);
+}
+
+static void usage(const char *program) {
+    fprintf(stderr,
+            "Uso: %s <padrao> <saida.bin|saida.log> [-n acessos] [-w escritas] [-s semente] [-r regiao_kb]\n"
+            "       [-S passo_bytes] [-z expoente] [-l laco_kb] [-P fases] [-b base_hex]\n\n"
+            "Padrões: seq, stride, uniform, zipf, loop e phases\n"
+            "-n acessos (padrão: 1000000)\n"
+            "-w fração de escritas, de 0 a 1 (padrão: 0.3)\n"
+            "-s semente (padrão: 1)\n"
+            "-r região de seq, stride, uniform e zipf em KB (padrão: 65536)\n"
+            "-S passo do stride em bytes (padrão: 4096)\n"
+            "-z expoente do Zipf (padrão: 0.99)\n"
+            "-l trecho do loop e conjunto de trabalho de cada fase em KB (padrão: 4096)\n"
+            "-P fases do phases (padrão: 4)\n"
+            "-b primeiro endereço da região, em hexadecimal (padrão: 10000000)\n", program);
+    exit(EXIT_FAILURE);
+}
+
+static int parse_pattern(const char *name) {
+    for (unsigned i = 0; i < NUM_PATTERNS; i++) {
+        if (strcmp(pattern_names[i], name) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// Bytes da região acessada pelo padrão
+static uint64_t region_span(const GeneratorConfig *config) {
+    if (config->pattern == PATTERN_LOOP) {
+        return (uint64_t)config->loop_kb * 1024;
+    }
+    if (config->pattern == PATTERN_PHASES) {
+        return (uint64_t)config->loop_kb * 1024 * config->phases;
+    }
+    return (uint64_t)config->region_kb * 1024;
+}
+
+// Confere que os endereços gerados cabem nos 64 bits do formato
+static int validate_config(const GeneratorConfig *config) {
+
+    uint64_t limit = UINT64_MAX - config->base;
+    uint64_t span = region_span(config);
+
+    if (config->accesses == 0) {
+        fprintf(stderr, "O trace precisa de ao menos um acesso\n");
+        return -1;
+    }
+    if (config->write_ratio < 0 || config->write_ratio > 1) {
+        fprintf(stderr, "Fração de escritas %.3f fora de [0, 1]\n", config->write_ratio);
+        return -1;
+    }
+    if (span < ZIPF_PAGE_SIZE || span > limit) {
+        fprintf(stderr, "Região de %llu KB fora dos limites de 4 KB a %llu KB\n",
+                (unsigned long long)(span / 1024), (unsigned long long)(limit / 1024));
+        return -1;
+    }
+    if (config->stride == 0 || config->phases == 0 || config->zipf_exponent <= 0) {
+        fprintf(stderr, "Passo, fases e expoente precisam ser positivos\n");
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+
+    if (argc < 3) {
+        usage(argv[0]);
+    }
+
+    GeneratorConfig config = {
+        .pattern = parse_pattern(argv[1]),
+        .accesses = 1000000,
+        .write_ratio = 0.3,
+        .seed = 1,
+        .region_kb = 65536,
+        .stride = 4096,
+        .zipf_exponent = 0.99,
+        .loop_kb = 4096,
+        .phases = 4,
+        .base = BASE_ADDRESS,
+    };
+    const char *path = argv[2];
+    if (config.pattern < 0) {
+        fprintf(stderr, "Padrão desconhecido: %s\n", argv[1]);
+        usage(argv[0]);
+    }
+
+    int opt;
+    optind = 3;
+    while ((opt = getopt(argc, argv, "n:w:s:r:S:z:l:P:b:")) != -1) {
+        switch (opt) {
+            case 'n': config.accesses = strtoul(optarg, NULL, 10); break;
+            case 'w': config.write_ratio = atof(optarg); break;
+            case 's': config.seed = strtoull(optarg, NULL, 10); break;
+            case 'r': config.region_kb = strtoul(optarg, NULL, 10); break;
+            case 'S': config.stride = strtoul(optarg, NULL, 10); break;
+            case 'z': config.zipf_exponent = atof(optarg); break;
+            case 'l': config.loop_kb = strtoul(optarg, NULL, 10); break;
+            case 'P': config.phases = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'b': config.base = strtoull(optarg, NULL, 16); break;
+            default: usage(argv[0]);
+        }
+    }
+    if (optind < argc) {
+        usage(argv[0]);
+    }
+    if (validate_config(&config) != 0) {
+        return 1;
+    }
+
+    // O xorshift não pode começar em zero
+    rng_state = config.seed * 0x9E3779B97F4A7C15ull + 1;
+
+    uint64_t region = (uint64_t)config.region_kb * 1024;
+    uint64_t loop = (uint64_t)config.loop_kb * 1024;
+    Zipf zipf = {0};
+    if (config.pattern == PATTERN_ZIPF && zipf_init(&zipf, region / ZIPF_PAGE_SIZE, config.zipf_exponent) != 0) {
+        return 1;
+    }
+    if (config.pattern == PATTERN_PHASES && zipf_init(&zipf, loop / ZIPF_PAGE_SIZE, config.zipf_exponent) != 0) {
+        return 1;
+    }
+
+    size_t length = strlen(path);
+    int text = length >= 4 && strcmp(path + length - 4, ".log") == 0;
+
+    FILE *output = fopen(path, text ? "w" : "wb");
+    if (!output) {
+        perror("Erro ao criar o arquivo de saída");
+        free(zipf.cdf);
+        return 1;
+    }
+
+    TraceHeader header;
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    header.address_bits = config.base + region_span(&config) > ((uint64_t)1 << 32) ? 64 : 32;
+    header.record_count = config.accesses;
+    if (!text) {
+        fwrite(&header, sizeof(header), 1, output);
+    }
+
+    uint64_t buffer[4096];
+    size_t buffered = 0;
+    unsigned long writes = 0;
+
+    for (unsigned long i = 0; i < config.accesses; i++) {
+
+        uint64_t addr = config.base;
+        switch (config.pattern) {
+        case PATTERN_SEQ:
+            addr += (uint64_t)i * LINE_SIZE % region;
+            break;
+        case PATTERN_STRIDE:
+            addr += (uint64_t)i * config.stride % region;
+            break;
+        case PATTERN_UNIFORM:
+            addr += rng_next() % (region / 4) * 4;
+            break;
+        case PATTERN_ZIPF:
+            addr = zipf_address(&zipf, config.base);
+            break;
+        case PATTERN_LOOP:
+            addr += (uint64_t)i * LINE_SIZE % loop;
+            break;
+        case PATTERN_PHASES: {
+            uint64_t phase = (uint64_t)i * config.phases / config.accesses;
+            addr = zipf_address(&zipf, config.base + phase * loop);
+            break;
+        }
+        }
+
+        int write = rng_uniform() < config.write_ratio;
+        writes += write;
+
+        if (text) {
+            fprintf(output, "%08llx %c\n", (unsigned long long)addr, write ? 'W' : 'R');
+            continue;
+        }
+        buffer[buffered++] = (addr & ~(uint64_t)TRACE_WRITE_BIT) | (write ? TRACE_WRITE_BIT : 0);
+        if (buffered == sizeof(buffer) / sizeof(buffer[0])) {
+            write_records(output, buffer, buffered, header.address_bits);
+            buffered = 0;
+        }
+    }
+    write_records(output, buffer, buffered, header.address_bits);
+    free(zipf.cdf);
+
+    if (fclose(output) != 0) {
+        perror("Erro ao gravar o arquivo de saída");
+        return 1;
+    }
+
+    printf("%s: %lu acessos (%s, %.1f%% escritas)\n", path, config.accesses, pattern_names[config.pattern],
+           100.0 * writes / config.accesses);
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "writeback.h"
+
+int writeback_parse_spec(const char *spec, unsigned *period, unsigned *batch,
+                         unsigned *background_ratio, unsigned *dirty_ratio) {
+
+    unsigned long values[4] = {0, WRITEBACK_DEFAULT_BATCH, WRITEBACK_DEFAULT_BACKGROUND_RATIO,
+                               WRITEBACK_DEFAULT_DIRTY_RATIO};
+    const char *text = spec;
+    for (int i = 0; i < 4; i++) {
+        char *end;
+        values[i] = strtoul(text, &end, 10);
+        if (end == text || (*end != '/' && *end != '\0') || (*end == '/' && i == 3)) {
+            fprintf(stderr, "Limpador inválido: %s (use periodo[/lote[/fundo[/limite]]], por exemplo 10000/32/10/20)\n", spec);
+            return -1;
+        }
+        if (*end == '\0') {
+            break;
+        }
+        text = end + 1;
+    }
+
+    if (values[0] == 0 || values[1] == 0 || values[0] > UINT_MAX || values[1] > UINT_MAX) {
+        fprintf(stderr, "Limpador inválido: %s (período e lote precisam ser positivos)\n", spec);
+        return -1;
+    }
+    if (values[2] > values[3] || values[3] > 100) {
+        fprintf(stderr, "Limpador inválido: %s (os percentuais precisam ter fundo <= limite <= 100)\n", spec);
+        return -1;
+    }
+
+    *period = (unsigned)values[0];
+    *batch = (unsigned)values[1];
+    *background_ratio = (unsigned)values[2];
+    *dirty_ratio = (unsigned)values[3];
+    return 0;
+}
+
+void writeback_init(Writeback *wb, unsigned period, unsigned batch,
+                    unsigned background_ratio, unsigned dirty_ratio, unsigned frames) {
+
+    memset(wb, 0, sizeof(*wb));
+    wb->next_wakeup = ULONG_MAX;
+    wb->next_periodic = ULONG_MAX;
+    wb->dirty_limit = UINT_MAX;
+    if (period == 0) {
+        return;
+    }
+
+    wb->period = period;
+    wb->batch = batch;
+    wb->background_ratio = background_ratio;
+    wb->dirty_ratio = dirty_ratio;
+    wb->background_limit = (unsigned)((unsigned long)frames * background_ratio / 100);
+    wb->dirty_limit = (unsigned)((unsigned long)frames * dirty_ratio / 100);
+    wb->next_periodic = period;
+    wb->next_wakeup = period;
+}
+
+unsigned writeback_begin(Writeback *wb, unsigned long now) {
+
+    // Parada no limite: quem escreveu limpa tudo o que passa do nível de fundo, sem lote.
+    // Se o despertar também venceu, ele fica para a próxima verificação
+    wb->throttled = wb->dirty > wb->dirty_limit;
+    if (wb->throttled) {
+        wb->throttles++;
+        wb->next_wakeup = wb->next_periodic;
+        return wb->dirty - wb->background_limit;
+    }
+
+    wb->wakeups++;
+    wb->next_periodic = now + wb->period;
+    wb->next_wakeup = wb->next_periodic;
+    if (wb->dirty <= wb->background_limit) {
+        return 0;
+    }
+    unsigned excess = wb->dirty - wb->background_limit;
+    return excess < wb->batch ? excess : wb->batch;
+}
+
+void writeback_print_stats(const Writeback *wb) {
+
+    printf("Despejos: %lu limpos, %lu sujos\n", wb->clean_evictions, wb->dirty_evictions);
+    if (!writeback_enabled(wb)) {
+        return;
+    }
+    printf("Limpador: a cada %lu acessos, lotes de %u, fundo de %u%% (%u quadros), limite de %u%% (%u quadros)\n",
+           wb->period, wb->batch, wb->background_ratio, wb->background_limit, wb->dirty_ratio, wb->dirty_limit);
+    printf("Escritas antecipadas: %lu em segundo plano (%lu despertares), %lu em %lu paradas no limite\n",
+           wb->background_writes, wb->wakeups, wb->throttled_writes, wb->throttles);
+}
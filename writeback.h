@@ -0,0 +1,108 @@
+#ifndef WRITEBACK_H
+#define WRITEBACK_H
+
+#include <limits.h>
+
+// Modelo de um limpador de páginas sujas em segundo plano (como as threads de flush do Linux),
+// compartilhado pelas quatro tabelas. Sem ele uma página suja só é escrita quando é despejada,
+// com a falta esperando a escrita. Com ele, a cada period acessos o limpador acorda e, se houver
+// mais sujas residentes que background_limit, escreve até batch delas, percorrendo os quadros
+// num relógio próprio; a página continua residente, só que limpa, e o despejo dela depois sai de
+// graça. Se as sujas passarem de dirty_limit, quem escreveu para e limpa até voltar a
+// background_limit (o balance_dirty_pages do Linux).
+// O simulador guarda o bit de suja onde sempre guardou; aqui ficam só a contagem de sujas
+// residentes, o agendamento e as estatísticas. A escolha de vítimas não muda, só quais despejos
+// são sujos
+
+// Valores padrão da opção wb= (os de vm.dirty_background_ratio e vm.dirty_ratio do Linux)
+#define WRITEBACK_DEFAULT_BATCH 32
+#define WRITEBACK_DEFAULT_BACKGROUND_RATIO 10
+#define WRITEBACK_DEFAULT_DIRTY_RATIO 20
+
+typedef struct {
+    unsigned long period;           // acessos entre despertares; 0 = limpador desligado
+    unsigned batch;
+    unsigned background_ratio;      // % dos quadros
+    unsigned dirty_ratio;
+    unsigned background_limit;      // sujas residentes acima das quais o limpador escreve
+    unsigned dirty_limit;           // sujas residentes acima das quais quem escreve para
+
+    unsigned long next_wakeup;      // próxima rodada: o despertar, ou 0 se as sujas passaram do limite
+    unsigned long next_periodic;    // próximo despertar; ULONG_MAX com o limpador desligado
+    unsigned dirty;                 // páginas sujas residentes
+    unsigned hand;                  // próximo quadro que o limpador examina
+    int throttled;                  // a rodada atual é uma parada no limite
+
+    unsigned long clean_evictions;
+    unsigned long dirty_evictions;      // escritas na hora do despejo
+    unsigned long background_writes;    // escritas pelo limpador
+    unsigned long throttled_writes;     // escritas por quem parou no limite
+    unsigned long wakeups;
+    unsigned long throttles;
+} Writeback;
+
+// Lê "periodo[/lote[/fundo[/limite]]]" (ex.: 10000/32/10/20), com os percentuais de quadros.
+// Retorna 0 ou -1, com a mensagem de erro já impressa
+int writeback_parse_spec(const char *spec, unsigned *period, unsigned *batch,
+                         unsigned *background_ratio, unsigned *dirty_ratio);
+
+// period == 0 deixa o limpador desligado; a contagem de despejos limpos e sujos é feita do mesmo jeito
+void writeback_init(Writeback *wb, unsigned period, unsigned batch,
+                    unsigned background_ratio, unsigned dirty_ratio, unsigned frames);
+
+// Começa uma rodada de limpeza no instante now. Devolve quantas páginas sujas o simulador deve
+// escrever (marcando cada uma com writeback_cleaned), que nunca passa das sujas residentes
+unsigned writeback_begin(Writeback *wb, unsigned long now);
+
+// Configuração e divisão das escritas; imprime só os despejos com o limpador desligado
+void writeback_print_stats(const Writeback *wb);
+
+static inline int writeback_enabled(const Writeback *wb) {
+    return wb->period != 0;
+}
+
+// Hora de uma rodada: o limpador acordou ou as sujas passaram do limite. Desligado, nunca.
+// É a única verificação feita a cada acesso, então as duas condições viram uma comparação
+static inline int writeback_due(const Writeback *wb, unsigned long now) {
+    return now >= wb->next_wakeup;
+}
+
+// Quantos acessos seguintes à mesma página uma sequência que começa depois do instante now pode
+// juntar sem pular uma rodada: a sequência termina no despertar, e com as sujas no limite cada
+// acesso vai sozinho, já que a escrita que passa do limite para quem escreveu no mesmo acesso.
+// Fora desses pontos nenhuma rodada acontece no meio da sequência, então juntá-la dá o mesmo
+// resultado que simular acesso por acesso, em qualquer formato de trace
+static inline unsigned long writeback_run_limit(const Writeback *wb, unsigned long now) {
+    if (wb->dirty >= wb->dirty_limit || wb->next_wakeup <= now + 1) {
+        return 0;
+    }
+    return wb->next_wakeup - now - 1;
+}
+
+// pages páginas residentes limpas (0 ou 1) passaram a estar sujas. Recebe a contagem em vez de
+// ser chamada só nas escritas para o laço de acessos não desviar pelo tipo de cada acesso
+static inline void writeback_dirtied(Writeback *wb, unsigned pages) {
+    wb->dirty += pages;
+    if (wb->dirty > wb->dirty_limit) {
+        wb->next_wakeup = 0;
+    }
+}
+
+// O simulador escreveu uma página suja na rodada e desligou o bit de suja dela
+static inline void writeback_cleaned(Writeback *wb) {
+    wb->dirty--;
+    if (wb->throttled) {
+        wb->throttled_writes++;
+    } else {
+        wb->background_writes++;
+    }
+}
+
+// Despejo de uma página residente, suja ou não (0 ou 1), sem desviar por isso
+static inline void writeback_evicted(Writeback *wb, unsigned dirty) {
+    wb->dirty -= dirty;
+    wb->dirty_evictions += dirty;
+    wb->clean_evictions += 1 - dirty;
+}
+
+#endif